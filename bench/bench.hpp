@@ -0,0 +1,242 @@
+#ifndef STCP_BENCH_HPP
+#define STCP_BENCH_HPP
+
+// ベンチマークの共通部分
+// 各ケースを 1 行の JSON で標準出力に書く:
+//   {"suite", "name", "workload", "n", "ops", "ns_per_op", "ops_per_s", "peak_rss_kb", "perf", "check"}
+// 環境変数 STCP_BENCH_PERF=1 のとき perf_event_open でハードウェアカウンタも数える (使えなければ null)
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace bench {
+    // 添字列の作り方
+    //   random: 一様乱数, skewed: 先頭に偏った冪乗則, sequential: 0, 1, 2, ... の繰り返し
+    enum class workload {
+        random, skewed, sequential
+    };
+
+    inline const workload workloads[] = { workload::random, workload::skewed, workload::sequential };
+
+    inline const char *name_of(workload w) {
+        switch (w) {
+            case workload::random: return "random";
+            case workload::skewed: return "skewed";
+            default: return "sequential";
+        }
+    }
+
+    // [0, n) の添字を q 個 (seed を固定して再現可能にする)
+    inline std::vector<std::size_t> indices(workload w, std::size_t n, std::size_t q, std::uint64_t seed = 1) {
+        std::mt19937_64 rng(seed);
+        std::uniform_real_distribution<double> unit(0, 1);
+
+        std::vector<std::size_t> v(q);
+        for (std::size_t i = 0; i < q; ++i) {
+            switch (w) {
+                case workload::random:
+                    v[i] = rng() % n;
+                    break;
+                case workload::skewed:
+                    v[i] = std::min(n - 1, std::size_t(n * std::pow(unit(rng), 4)));
+                    break;
+                default:
+                    v[i] = i % n;
+                    break;
+            }
+        }
+        return v;
+    }
+
+    // [0, n) の半開区間を q 個
+    // sequential は幅 sqrt(n) の窓を 1 ずつずらす
+    inline std::vector<std::pair<std::size_t, std::size_t>> ranges(workload w, std::size_t n, std::size_t q, std::uint64_t seed = 2) {
+        std::vector<std::pair<std::size_t, std::size_t>> v(q);
+
+        if (w == workload::sequential) {
+            auto width = std::max<std::size_t>(1, std::size_t(std::sqrt(double(n))));
+            for (std::size_t i = 0; i < q; ++i) {
+                auto l = i % (n - width + 1);
+                v[i] = { l, std::min(n, l + width) };
+            }
+            return v;
+        }
+
+        auto a = indices(w, n, q, seed), b = indices(w, n + 1, q, seed + 1);
+        for (std::size_t i = 0; i < q; ++i) {
+            v[i] = std::minmax(a[i], b[i]);
+        }
+        return v;
+    }
+
+    // 対象プロセスの VmHWM (KiB)
+    inline long peak_rss_kb() {
+        std::ifstream in("/proc/self/status");
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.rfind("VmHWM:", 0) == 0) {
+                return std::strtol(line.c_str() + 6, nullptr, 10);
+            }
+        }
+        return -1;
+    }
+
+    // VmHWM を現在の RSS に戻す (書き込めなければ何もしない)
+    inline void reset_peak_rss() {
+        std::ofstream out("/proc/self/clear_refs");
+        out << "5" << std::flush;
+    }
+
+    struct perf_counters {
+        perf_counters():
+            enabled_(false) {
+            auto env = std::getenv("STCP_BENCH_PERF");
+            if (env == nullptr || std::strcmp(env, "1") != 0) {
+                return;
+            }
+            enabled_ = true;
+
+            open("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+            open("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+            open("branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+            open("cache_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+            open("dtlb_load_misses", PERF_TYPE_HW_CACHE,
+                PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+        }
+
+        perf_counters(const perf_counters &) = delete;
+        perf_counters &operator=(const perf_counters &) = delete;
+
+        ~perf_counters() {
+            for (auto &[name, fd] : fds_) {
+                if (0 <= fd) {
+                    close(fd);
+                }
+            }
+        }
+
+        void start() {
+            for (auto &[name, fd] : fds_) {
+                if (0 <= fd) {
+                    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+        }
+
+        // 1 操作あたりの値を JSON のオブジェクトにする (無効なら null)
+        std::string stop(std::size_t ops) {
+            if (!enabled_) {
+                return "null";
+            }
+
+            std::ostringstream out;
+            out << "{";
+            for (std::size_t i = 0; i < fds_.size(); ++i) {
+                auto &[name, fd] = fds_[i];
+                out << (i == 0 ? "" : ", ") << "\"" << name << "\": ";
+
+                std::int64_t x = 0;
+                if (fd < 0) {
+                    out << "null";
+                    continue;
+                }
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+                if (read(fd, &x, sizeof(x)) != sizeof(x)) {
+                    out << "null";
+                    continue;
+                }
+                out << double(x) / ops;
+            }
+            out << "}";
+
+            return out.str();
+        }
+
+    private:
+        void open(const char *name, std::uint32_t type, std::uint64_t config) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            fds_.emplace_back(name, int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0)));
+        }
+
+        bool enabled_;
+        std::vector<std::pair<const char *, int>> fds_;
+    };
+
+    // ./suite [n_max] [n_min] [q] で n = n_min, 10 n_min, ... , n_max を回す (既定 10^3 .. 10^6, q = 2^20)
+    struct suite {
+        suite(const char *name, int argc, char **argv):
+            name_(name) {
+            n_max_ = argc < 2 ? 1000000 : std::strtoull(argv[1], nullptr, 10);
+            n_min_ = argc < 3 ? 1000 : std::strtoull(argv[2], nullptr, 10);
+            q_ = argc < 4 ? std::size_t(1) << 20 : std::strtoull(argv[3], nullptr, 10);
+        }
+
+        // 1 ケースあたりの操作の回数
+        std::size_t queries() const {
+            return q_;
+        }
+
+        std::vector<std::size_t> sizes() const {
+            std::vector<std::size_t> v;
+            for (std::size_t n = n_min_; n <= n_max_; n *= 10) {
+                v.push_back(n);
+            }
+            return v;
+        }
+
+        // 構築の前に呼ぶと, peak_rss_kb がそのケースで確保した分を含むようになる
+        void begin() {
+            reset_peak_rss();
+        }
+
+        // f() を 1 回呼び, ops 回の操作として記録する
+        // f は最適化で消されないための値を返す
+        template <typename F>
+        void measure(const std::string &name, workload w, std::size_t n, std::size_t ops, F f) {
+            perf_.start();
+            auto start = std::chrono::steady_clock::now();
+            auto check = f();
+            auto end = std::chrono::steady_clock::now();
+            auto perf = perf_.stop(ops);
+
+            auto ns = std::chrono::duration<double, std::nano>(end - start).count();
+
+            std::cout << "{\"suite\": \"" << name_ << "\", \"name\": \"" << name << "\", \"workload\": \"" << name_of(w)
+                      << "\", \"n\": " << n << ", \"ops\": " << ops
+                      << ", \"ns_per_op\": " << ns / ops << ", \"ops_per_s\": " << ops / ns * 1e9
+                      << ", \"peak_rss_kb\": " << peak_rss_kb() << ", \"perf\": " << perf
+                      << ", \"check\": " << std::uint64_t(check) << "}" << std::endl;
+        }
+
+    private:
+        const char *name_;
+        std::size_t n_min_, n_max_, q_;
+        perf_counters perf_;
+    };
+}
+
+#endif // STCP_BENCH_HPP
@@ -0,0 +1,71 @@
+// 座標圧縮を std::sort + std::unique + std::lower_bound と stcp/compress.hpp で比較する
+// ./compress [n] (既定 10^7 個, 値は 64 ビットの乱数)
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <stcp/compress.hpp>
+using namespace std;
+
+template <typename F>
+void measure(const string &name, size_t n, F f) {
+    auto start = chrono::steady_clock::now();
+    auto check = f();
+    auto end = chrono::steady_clock::now();
+
+    cout << "{\"name\": \"" << name << "\", \"ns_per_op\": " << chrono::duration<double, nano>(end - start).count() / n
+         << ", \"check\": " << check << "}" << endl;
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc < 2 ? 10000000 : strtoull(argv[1], nullptr, 10);
+
+    mt19937_64 rng(1);
+    vector<int64_t> a(n), qs(n);
+    for (auto &x : a) {
+        x = int64_t(rng() >> 1);
+    }
+    for (auto &x : qs) {
+        x = a[rng() % n];
+    }
+
+    vector<int64_t> values;
+    measure("build/std_sort", n, [&] {
+        values = a;
+        sort(values.begin(), values.end());
+        values.erase(unique(values.begin(), values.end()), values.end());
+
+        vector<uint32_t> ids(n);
+        for (size_t i = 0; i < n; ++i) {
+            ids[i] = uint32_t(lower_bound(values.begin(), values.end(), a[i]) - values.begin());
+        }
+        return ids[n / 2];
+    });
+
+    stcp::coordinate_compression<int64_t> cc;
+    measure("build/stcp_radix", n, [&] {
+        cc = stcp::coordinate_compression<int64_t>(a);
+        return cc.ids()[n / 2];
+    });
+
+    measure("lookup/std_lower_bound", n, [&] {
+        uint64_t sum = 0;
+        for (auto x : qs) {
+            sum += lower_bound(values.begin(), values.end(), x) - values.begin();
+        }
+        return sum;
+    });
+
+    measure("lookup/stcp_eytzinger", n, [&] {
+        uint64_t sum = 0;
+        for (auto x : qs) {
+            sum += cc.lower_bound(x);
+        }
+        return sum;
+    });
+}
@@ -0,0 +1,74 @@
+// doubling::connect の状態を値で返す場合と参照で書き換える場合の比較 (状態に bint を持つ)
+
+#define STCP_ENABLE_MULTIPRECISION
+
+#include <iostream>
+#include <vector>
+#include <tuple>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <stcp/doubling.hpp>
+using namespace std;
+
+template <typename F>
+double measure(int q, F f) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < q; ++i) {
+        f(i);
+    }
+    auto end = chrono::steady_clock::now();
+
+    return chrono::duration<double, nano>(end - start).count() / q;
+}
+
+int main() {
+    constexpr int m = 1000, log2 = 60, q = 2000;
+
+    vector<pair<int, stcp::bint>> next(m);
+    for (int i = 0; i < m; ++i) {
+        next[i] = { (int64_t(i) * i + 1) % m, (stcp::bint(1) << 512) + i };
+    }
+
+    auto dub = stcp::make_doubling<int64_t>(log2, next, [&](auto &x, auto &y) {
+        vector<pair<int, stcp::bint>> z(m);
+        for (int i = 0; i < m; ++i) {
+            auto &[s, p] = x[i];
+            auto &[t, q] = y[s];
+            z[i] = { t, p + q };
+        }
+        return z;
+    });
+
+    auto by_value = dub.connect([](auto &g, auto &args) {
+        auto [s, p] = args;
+        auto &[t, q] = g[s];
+        return make_tuple(t, stcp::bint(p + q));
+    });
+
+    auto in_place = dub.connect([](auto &g, auto &args) {
+        auto &[s, p] = args;
+        auto &[t, q] = g[s];
+        s = t; p += q;
+    });
+
+    mt19937_64 rng(0);
+    vector<int64_t> k(q);
+    for (auto &e : k) {
+        e = rng() >> 4;
+    }
+
+    stcp::bint check1 = 0, check2 = 0;
+
+    auto t1 = measure(q, [&](int i) {
+        check1 += get<1>(by_value(k[i], 0, stcp::bint(0)));
+    });
+    auto t2 = measure(q, [&](int i) {
+        check2 += get<1>(in_place(k[i], 0, stcp::bint(0)));
+    });
+
+    cout << "{\"name\": \"doubling_connect/by_value\", \"ns_per_op\": " << t1 << "}\n";
+    cout << "{\"name\": \"doubling_connect/in_place\", \"ns_per_op\": " << t2 << "}\n";
+
+    return check1 == check2 ? 0 : 1;
+}
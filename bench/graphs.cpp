@@ -0,0 +1,204 @@
+// ダブリングと木: doubling, functional_graph_doubling, functional_graph_cycle, tree_lifting, compact_tree_lifting, euler_tour_lca
+
+#include <vector>
+#include <random>
+#include <cstdint>
+#include "bench.hpp"
+#include <stcp/monoid.hpp>
+#include <stcp/doubling.hpp>
+#include <stcp/functional_graph_doubling.hpp>
+#include <stcp/functional_graph_cycle.hpp>
+#include <stcp/tree_lifting.hpp>
+using namespace std;
+
+using u32 = uint32_t;
+using u64 = uint64_t;
+using sum = stcp::sum_monoid<u64>;
+
+// ダブリングの表は (max_log2 + 1) n 要素になるので, これより大きい n は飛ばす
+constexpr size_t table_max_n = 1000000;
+constexpr size_t max_log2 = 30;
+
+// 次の頂点 (sequential は 1 つの大きな閉路, skewed は先頭の少数の頂点に集まる)
+vector<u32> functional_graph(bench::workload w, size_t n) {
+    auto xs = bench::indices(w, n, n, 5);
+
+    vector<u32> next(n);
+    for (size_t v = 0; v < n; ++v) {
+        next[v] = u32((xs[v] + 1) % n);
+    }
+    return next;
+}
+
+// 親 (0 が根, parent[0] = 0)
+// random は一様な祖先で浅い木, skewed は直前の頂点の近くで深い木, sequential はパス
+vector<u32> tree(bench::workload w, size_t n) {
+    auto xs = bench::indices(bench::workload::random, n, n, 6);
+
+    vector<u32> parent(n, 0);
+    for (size_t v = 1; v < n; ++v) {
+        switch (w) {
+            case bench::workload::random:
+                parent[v] = u32(xs[v] % v);
+                break;
+            case bench::workload::skewed:
+                parent[v] = u32(v - 1 - xs[v] % min<size_t>(v, 8));
+                break;
+            default:
+                parent[v] = u32(v - 1);
+                break;
+        }
+    }
+    return parent;
+}
+
+vector<u64> steps(size_t q) {
+    mt19937_64 rng(7);
+
+    vector<u64> k(q);
+    for (auto &x : k) {
+        x = rng() >> (64 - max_log2);
+    }
+    return k;
+}
+
+void doubling_case(bench::suite &s, bench::workload w, size_t n) {
+    auto q = s.queries();
+    auto next = functional_graph(w, n);
+    auto vs = bench::indices(w, n, q);
+    auto ks = steps(q);
+
+    s.begin();
+    auto dub = stcp::make_doubling<u64>(max_log2, next, [&](auto &x, auto &y) {
+        vector<u32> z(n);
+        for (size_t i = 0; i < n; ++i) {
+            z[i] = y[x[i]];
+        }
+        return z;
+    });
+    auto f = dub.connect([](auto &g, auto &t) {
+        get<0>(t) = g[get<0>(t)];
+    });
+
+    s.measure("doubling::connect", w, n, q, [&] {
+        u64 acc = 0;
+        for (size_t i = 0; i < q; ++i) {
+            acc += get<0>(f(ks[i], u32(vs[i])));
+        }
+        return acc;
+    });
+}
+
+void functional_graph_case(bench::suite &s, bench::workload w, size_t n) {
+    auto q = s.queries();
+    auto next = functional_graph(w, n);
+    vector<u64> agg(n);
+    for (size_t v = 0; v < n; ++v) {
+        agg[v] = v;
+    }
+    auto vs = bench::indices(w, n, q);
+    auto ks = steps(q);
+
+    if (n <= table_max_n) {
+        s.begin();
+        stcp::functional_graph_doubling<u32, u64, sum::op, sum::e> dub(max_log2, next, agg);
+        s.measure("functional_graph_doubling::jump", w, n, q, [&] {
+            u64 acc = 0;
+            for (size_t i = 0; i < q; ++i) {
+                acc += dub.jump(u32(vs[i]), ks[i]).second;
+            }
+            return acc;
+        });
+
+        vector<u32> v(vs.begin(), vs.end());
+        vector<u64> a;
+        s.measure("functional_graph_doubling::jump_many", w, n, q, [&] {
+            dub.jump_many(v, a, ks[0]);
+            u64 acc = 0;
+            for (auto x : a) {
+                acc += x;
+            }
+            return acc;
+        });
+    }
+
+    s.begin();
+    stcp::functional_graph_cycle<u32, u64, sum::op, sum::e, sum::inv> cyc(next, agg);
+    s.measure("functional_graph_cycle::jump", w, n, q, [&] {
+        u64 acc = 0;
+        for (size_t i = 0; i < q; ++i) {
+            acc += cyc.jump(u32(vs[i]), ks[i]).second;
+        }
+        return acc;
+    });
+}
+
+template <typename Tree>
+void tree_case(bench::suite &s, const char *name, bench::workload w, size_t n, const Tree &t) {
+    auto q = s.queries();
+    auto us = bench::indices(bench::workload::random, n, q, 8), vs = bench::indices(w, n, q, 9);
+
+    s.measure(string(name) + "::lca", w, n, q, [&] {
+        u64 acc = 0;
+        for (size_t i = 0; i < q; ++i) {
+            acc += t.lca(u32(us[i]), u32(vs[i]));
+        }
+        return acc;
+    });
+    s.measure(string(name) + "::prod", w, n, q, [&] {
+        u64 acc = 0;
+        for (size_t i = 0; i < q; ++i) {
+            acc += t.prod(u32(us[i]), u32(vs[i]));
+        }
+        return acc;
+    });
+}
+
+void tree_lifting_case(bench::suite &s, bench::workload w, size_t n) {
+    auto parent = tree(w, n);
+    vector<u64> weight(n);
+    for (size_t v = 0; v < n; ++v) {
+        weight[v] = v;
+    }
+
+    if (n <= table_max_n) {
+        s.begin();
+        stcp::tree_lifting<u32, u64, sum::op, sum::e> t(parent, weight);
+        tree_case(s, "tree_lifting", w, n, t);
+
+        s.begin();
+        stcp::tree_lifting<u32, u64, sum::op, sum::e> te(parent, weight, true);
+        tree_case(s, "tree_lifting<euler>", w, n, te);
+    }
+
+    s.begin();
+    stcp::compact_tree_lifting<u32, u64, sum::op, sum::e> c(parent, weight);
+    tree_case(s, "compact_tree_lifting", w, n, c);
+
+    auto q = s.queries();
+    auto us = bench::indices(bench::workload::random, n, q, 8), vs = bench::indices(w, n, q, 9);
+
+    s.begin();
+    stcp::euler_tour_lca<u32> e(parent);
+    s.measure("euler_tour_lca::lca", w, n, q, [&] {
+        u64 acc = 0;
+        for (size_t i = 0; i < q; ++i) {
+            acc += e.lca(u32(us[i]), u32(vs[i]));
+        }
+        return acc;
+    });
+}
+
+int main(int argc, char **argv) {
+    bench::suite s("graphs", argc, argv);
+
+    for (auto n : s.sizes()) {
+        for (auto w : bench::workloads) {
+            if (n <= table_max_n) {
+                doubling_case(s, w, n);
+            }
+            functional_graph_case(s, w, n);
+            tree_lifting_case(s, w, n);
+        }
+    }
+}
@@ -0,0 +1,132 @@
+// segment_tree::prod を std::allocator と huge_page_allocator で比較する
+// 利用できれば perf_event_open で dTLB のロードミスも数える
+// ./huge_page [log2 n] (既定 24)
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <stcp/segment_tree.hpp>
+#include <stcp/huge_page_allocator.hpp>
+using namespace std;
+
+int64_t op(int64_t x, int64_t y) {
+    return x + y;
+}
+int64_t e() {
+    return 0;
+}
+
+// dTLB のロードミスのカウンタ (開けなければ -1)
+struct tlb_counter {
+    tlb_counter() {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    ~tlb_counter() {
+        if (0 <= fd) {
+            close(fd);
+        }
+    }
+
+    void start() {
+        if (0 <= fd) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    int64_t stop() {
+        if (fd < 0) {
+            return -1;
+        }
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        int64_t x = 0;
+        if (read(fd, &x, sizeof(x)) != sizeof(x)) {
+            return -1;
+        }
+        return x;
+    }
+
+    int fd;
+};
+
+// このプロセスでヒュージページに載っている無名メモリ (KiB, 読めなければ -1)
+int64_t anon_huge_kb() {
+    ifstream in("/proc/self/smaps");
+    if (!in) {
+        return -1;
+    }
+
+    int64_t sum = 0;
+    string line;
+    while (getline(in, line)) {
+        if (line.rfind("AnonHugePages:", 0) == 0) {
+            sum += strtoll(line.c_str() + 14, nullptr, 10);
+        }
+    }
+    return sum;
+}
+
+template <typename Tree>
+void measure(const string &name, size_t n, const vector<pair<size_t, size_t>> &qs) {
+    Tree seg(n);
+    for (size_t i = 0; i < n; ++i) {
+        seg.set(i, int64_t(i));
+    }
+
+    tlb_counter tlb;
+
+    tlb.start();
+    auto start = chrono::steady_clock::now();
+    int64_t check = 0;
+    for (auto [l, r] : qs) {
+        check += seg.prod(l, r);
+    }
+    auto end = chrono::steady_clock::now();
+    auto misses = tlb.stop();
+
+    cout << "{\"name\": \"" << name << "\", \"ns_per_op\": " << chrono::duration<double, nano>(end - start).count() / qs.size()
+         << ", \"dtlb_misses_per_op\": ";
+    if (misses < 0) {
+        cout << "null";
+    }
+    else {
+        cout << double(misses) / qs.size();
+    }
+    cout << ", \"anon_huge_kb\": " << anon_huge_kb() << ", \"check\": " << check << "}" << endl;
+}
+
+int main(int argc, char **argv) {
+    size_t log2 = argc < 2 ? 24 : strtoull(argv[1], nullptr, 10);
+    size_t n = size_t(1) << log2, q = 2000000;
+
+    mt19937_64 rng(1);
+    vector<pair<size_t, size_t>> qs(q);
+    for (auto &[l, r] : qs) {
+        l = rng() % n; r = rng() % n;
+        if (r < l) {
+            swap(l, r);
+        }
+    }
+
+    measure<stcp::segment_tree<int64_t, op, e>>("prod/std_allocator", n, qs);
+    measure<stcp::segment_tree<int64_t, op, e, false, stcp::huge_page_allocator<int64_t>>>("prod/huge_page_allocator", n, qs);
+}
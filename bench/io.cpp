@@ -0,0 +1,136 @@
+// 整数の読み書きの速さを iostream, stdio, stcp/io.hpp で比較する
+// ./io [n] (既定 10^7 個)
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stcp/io.hpp>
+using namespace std;
+
+template <typename F>
+void measure(const string &name, size_t n, size_t bytes, F f) {
+    auto start = chrono::steady_clock::now();
+    auto check = f();
+    auto end = chrono::steady_clock::now();
+
+    auto ns = chrono::duration<double, nano>(end - start).count();
+    cout << "{\"name\": \"" << name << "\", \"ns_per_op\": " << ns / n
+         << ", \"mb_per_s\": " << bytes / ns * 1000 << ", \"check\": " << check << "}" << endl;
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc < 2 ? 10000000 : strtoull(argv[1], nullptr, 10);
+    const char *path = "io_input.txt";
+
+    mt19937_64 rng(1);
+    vector<int64_t> a(n);
+    for (auto &x : a) {
+        x = int64_t(rng() % 2000000001) - 1000000000;
+    }
+
+    {
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        stcp::writer out(fd);
+        for (auto x : a) {
+            out << x << '\n';
+        }
+        out.flush();
+        close(fd);
+    }
+
+    size_t bytes = 0;
+    if (auto f = fopen(path, "rb")) {
+        fseek(f, 0, SEEK_END);
+        bytes = ftell(f);
+        fclose(f);
+    }
+
+    measure("read/iostream", n, bytes, [&] {
+        freopen(path, "r", stdin);
+        ios::sync_with_stdio(false);
+        cin.tie(nullptr);
+        int64_t sum = 0, x;
+        for (size_t i = 0; i < n; ++i) {
+            cin >> x; sum += x;
+        }
+        return sum;
+    });
+
+    measure("read/scanf", n, bytes, [&] {
+        auto f = fopen(path, "r");
+        int64_t sum = 0;
+        long long x;
+        for (size_t i = 0; i < n; ++i) {
+            if (fscanf(f, "%lld", &x) == 1) {
+                sum += x;
+            }
+        }
+        fclose(f);
+        return sum;
+    });
+
+    measure("read/stcp_mmap", n, bytes, [&] {
+        int fd = open(path, O_RDONLY);
+        int64_t sum = 0;
+        {
+            stcp::reader in(fd);
+            for (size_t i = 0; i < n; ++i) {
+                sum += in.read<int64_t>();
+            }
+        }
+        close(fd);
+        return sum;
+    });
+
+    measure("read/stcp_pipe", n, bytes, [&] {
+        auto f = popen((string("cat ") + path).c_str(), "r");
+        int64_t sum = 0;
+        {
+            stcp::reader in(fileno(f));
+            for (size_t i = 0; i < n; ++i) {
+                sum += in.read<int64_t>();
+            }
+        }
+        pclose(f);
+        return sum;
+    });
+
+    measure("write/iostream", n, bytes, [&] {
+        ofstream out("/dev/null");
+        for (auto x : a) {
+            out << x << '\n';
+        }
+        return 0;
+    });
+
+    measure("write/printf", n, bytes, [&] {
+        auto f = fopen("/dev/null", "w");
+        for (auto x : a) {
+            fprintf(f, "%lld\n", (long long)x);
+        }
+        fclose(f);
+        return 0;
+    });
+
+    measure("write/stcp", n, bytes, [&] {
+        int fd = open("/dev/null", O_WRONLY);
+        {
+            stcp::writer out(fd);
+            for (auto x : a) {
+                out << x << '\n';
+            }
+        }
+        close(fd);
+        return 0;
+    });
+
+    unlink(path);
+}
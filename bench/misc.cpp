@@ -0,0 +1,72 @@
+// 座標圧縮と剰余環: radix_sort, coordinate_compression, montgomery_modint, barrett_modint
+
+#include <vector>
+#include <cstdint>
+#include "bench.hpp"
+#include <stcp/compress.hpp>
+#include <stcp/modint.hpp>
+using namespace std;
+
+using u64 = uint64_t;
+
+// 値の範囲は n によらず [0, 2^40) に取り, 重複の度合いを workload で変える
+constexpr size_t value_range = size_t(1) << 40;
+
+void compress_case(bench::suite &s, bench::workload w, size_t n) {
+    auto q = s.queries();
+    auto keys = bench::indices(w, value_range, n, 10);
+    auto xs = bench::indices(bench::workload::random, value_range, q, 11);
+
+    s.begin();
+    vector<u64> a(keys.begin(), keys.end());
+    s.measure("radix_sort", w, n, n, [&] {
+        stcp::radix_sort(a);
+        return a[n / 2];
+    });
+
+    s.begin();
+    stcp::coordinate_compression<u64> cc;
+    s.measure("coordinate_compression::build", w, n, n, [&] {
+        cc = stcp::coordinate_compression<u64>(vector<u64>(keys.begin(), keys.end()));
+        return cc.size();
+    });
+    s.measure("coordinate_compression::lower_bound", w, n, q, [&] {
+        u64 acc = 0;
+        for (auto x : xs) {
+            acc += cc.lower_bound(x);
+        }
+        return acc;
+    });
+}
+
+// acc <- acc a[i] + b[i] を添字列に沿って q 回
+template <typename T>
+void modint_case(bench::suite &s, const char *name, bench::workload w, size_t n) {
+    auto q = s.queries();
+    auto is = bench::indices(w, n, q);
+    auto as = bench::indices(bench::workload::random, 1u << 30, n, 12), bs = bench::indices(bench::workload::random, 1u << 30, n, 13);
+
+    s.begin();
+    vector<T> a(as.begin(), as.end()), b(bs.begin(), bs.end());
+    s.measure(string(name) + "::affine", w, n, q, [&] {
+        T acc = 1;
+        for (auto i : is) {
+            acc = acc * a[i] + b[i];
+        }
+        return acc.val();
+    });
+}
+
+int main(int argc, char **argv) {
+    bench::suite s("misc", argc, argv);
+
+    stcp::modint::set_mod(998244353);
+
+    for (auto n : s.sizes()) {
+        for (auto w : bench::workloads) {
+            compress_case(s, w, n);
+            modint_case<stcp::modint998244353>(s, "montgomery_modint", w, n);
+            modint_case<stcp::modint>(s, "barrett_modint", w, n);
+        }
+    }
+}
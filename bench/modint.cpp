@@ -0,0 +1,141 @@
+// アフィン写像 x -> ax + b を mod p で合成し続ける速さを, 剰余演算の実装ごとに比較する
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <stcp/modint.hpp>
+using namespace std;
+
+template <typename F>
+void measure(const string &name, int q, F f) {
+    auto start = chrono::steady_clock::now();
+    auto check = f();
+    auto end = chrono::steady_clock::now();
+
+    cout << "{\"name\": \"" << name << "\", \"ns_per_op\": " << chrono::duration<double, nano>(end - start).count() / q
+         << ", \"check\": " << check << "}" << endl;
+}
+
+template <typename T>
+uint32_t compose(const vector<pair<uint32_t, uint32_t>> &f, int q) {
+    // 係数は先に剰余環の元へ変換しておく
+    vector<pair<T, T>> g(f.size());
+    for (size_t i = 0; i < f.size(); ++i) {
+        g[i] = { f[i].first, f[i].second };
+    }
+
+    T a = 1, b = 0;
+    for (int i = 0; i < q; ++i) {
+        auto &[c, d] = g[i & (g.size() - 1)];
+        a *= c; b = b * c + d;
+    }
+    return (a + b).val();
+}
+
+// 互いに独立な乗算をまとめて行う (表の一斉更新)
+template <typename T>
+uint32_t multiply(const vector<pair<uint32_t, uint32_t>> &f, int q) {
+    vector<T> x(f.size()), y(f.size());
+    for (size_t i = 0; i < f.size(); ++i) {
+        x[i] = f[i].first; y[i] = f[i].second;
+    }
+
+    for (int r = 0; r < q / int(f.size()); ++r) {
+        for (size_t i = 0; i < f.size(); ++i) {
+            x[i] = x[i] * y[i] + y[i];
+        }
+    }
+
+    T acc = 0;
+    for (auto v : x) {
+        acc += v;
+    }
+    return acc.val();
+}
+
+int main(int argc, char **argv) {
+    constexpr int q = 50000000;
+    constexpr uint32_t p = 998244353;
+
+    // 実行時に決まる法 (入力から読む場合を想定)
+    uint64_t m = argc < 2 ? p : strtoull(argv[1], nullptr, 10);
+
+    mt19937 rng(1);
+    vector<pair<uint32_t, uint32_t>> f(1 << 10);
+    for (auto &[c, d] : f) {
+        c = rng() % p; d = rng() % p;
+    }
+
+    measure("affine/runtime_mod", q, [&] {
+        uint64_t a = 1, b = 0;
+        for (int i = 0; i < q; ++i) {
+            auto &[c, d] = f[i & (f.size() - 1)];
+            a = a * c % m; b = (b * c + d) % m;
+        }
+        return (a + b) % m;
+    });
+
+    measure("affine/constant_mod", q, [&] {
+        uint64_t a = 1, b = 0;
+        for (int i = 0; i < q; ++i) {
+            auto &[c, d] = f[i & (f.size() - 1)];
+            a = a * c % p; b = (b * c + d) % p;
+        }
+        return (a + b) % p;
+    });
+
+    measure("affine/montgomery", q, [&] {
+        return compose<stcp::montgomery_modint<p>>(f, q);
+    });
+
+    measure("affine/barrett", q, [&] {
+        stcp::modint::set_mod(m);
+        return compose<stcp::modint>(f, q);
+    });
+
+    measure("multiply/runtime_mod", q, [&] {
+        vector<uint64_t> x(f.size()), y(f.size());
+        for (size_t i = 0; i < f.size(); ++i) {
+            x[i] = f[i].first; y[i] = f[i].second;
+        }
+        for (int r = 0; r < q / int(f.size()); ++r) {
+            for (size_t i = 0; i < f.size(); ++i) {
+                x[i] = (x[i] * y[i] + y[i]) % m;
+            }
+        }
+        uint64_t acc = 0;
+        for (auto v : x) {
+            acc = (acc + v) % m;
+        }
+        return acc;
+    });
+
+    measure("multiply/constant_mod", q, [&] {
+        vector<uint64_t> x(f.size()), y(f.size());
+        for (size_t i = 0; i < f.size(); ++i) {
+            x[i] = f[i].first; y[i] = f[i].second;
+        }
+        for (int r = 0; r < q / int(f.size()); ++r) {
+            for (size_t i = 0; i < f.size(); ++i) {
+                x[i] = (x[i] * y[i] + y[i]) % p;
+            }
+        }
+        uint64_t acc = 0;
+        for (auto v : x) {
+            acc = (acc + v) % p;
+        }
+        return acc;
+    });
+
+    measure("multiply/montgomery", q, [&] {
+        return multiply<stcp::montgomery_modint<p>>(f, q);
+    });
+
+    measure("multiply/barrett", q, [&] {
+        stcp::modint::set_mod(m);
+        return multiply<stcp::modint>(f, q);
+    });
+}
@@ -0,0 +1,109 @@
+// 節点を確保する木: dynamic_segment_tree (std::allocator / arena_allocator), binary_trie_array
+
+#include <vector>
+#include <tuple>
+#include <optional>
+#include <cstdint>
+#include "bench.hpp"
+#include <stcp/monoid.hpp>
+#include <stcp/arena.hpp>
+#include <stcp/dynamic_segment_tree.hpp>
+#include <stcp/binary_trie_array.hpp>
+using namespace std;
+
+using u64 = uint64_t;
+using sum = stcp::sum_monoid<u64>;
+
+// binary_trie_array は Bits n 個の節点を持つので, これより大きい n は飛ばす
+constexpr size_t trie_max_n = 1000000;
+constexpr size_t trie_bits = 20;
+
+template <typename Tree, typename... Args>
+void dynamic_segment_tree_case(bench::suite &s, const char *name, bench::workload w, size_t n, Args &&...args) {
+    auto q = s.queries();
+    auto is = bench::indices(w, n, q);
+    auto rs = bench::ranges(w, n, q);
+
+    s.begin();
+    Tree seg(n, std::forward<Args>(args)...);
+    s.measure(string(name) + "::set", w, n, q, [&] {
+        for (size_t i = 0; i < q; ++i) {
+            seg.set(is[i], u64(i));
+        }
+        return seg.all_prod();
+    });
+    s.measure(string(name) + "::prod", w, n, q, [&] {
+        u64 acc = 0;
+        for (auto [l, r] : rs) {
+            acc += seg.prod(l, r);
+        }
+        return acc;
+    });
+}
+
+template <typename Trie, typename... Args>
+void binary_trie_array_case(bench::suite &s, const char *name, bench::workload w, size_t n, Args &&...args) {
+    auto q = s.queries();
+    auto vs = bench::indices(w, size_t(1) << trie_bits, n, 4);
+    auto rs = bench::ranges(w, n, q);
+
+    vector<typename Trie::query_type> qs(q);
+    for (size_t i = 0; i < q; ++i) {
+        auto [l, r] = rs[i];
+        if (l == r) {
+            ++r;
+        }
+        qs[i] = { l, r, (r - l) / 2 };
+    }
+
+    s.begin();
+    optional<Trie> trie;
+    s.measure(string(name) + "::build", w, n, n, [&] {
+        trie.emplace(vs, args...);
+        return trie->size();
+    });
+    s.measure(string(name) + "::nth_element", w, n, q, [&] {
+        size_t acc = 0;
+        for (auto [l, r, k] : qs) {
+            acc += trie->nth_element(l, r, k);
+        }
+        return acc;
+    });
+    s.measure(string(name) + "::nth_element(batch)", w, n, q, [&] {
+        size_t acc = 0;
+        for (auto x : trie->nth_element(qs)) {
+            acc += x;
+        }
+        return acc;
+    });
+    s.measure(string(name) + "::lower_bound", w, n, q, [&] {
+        size_t acc = 0;
+        for (auto [l, r, k] : qs) {
+            acc += trie->lower_bound(l, r, vs[k]);
+        }
+        return acc;
+    });
+}
+
+int main(int argc, char **argv) {
+    bench::suite s("node_trees", argc, argv);
+
+    for (auto n : s.sizes()) {
+        for (auto w : bench::workloads) {
+            dynamic_segment_tree_case<stcp::dynamic_segment_tree<u64, sum::op, sum::e>>(s, "dynamic_segment_tree", w, n);
+            {
+                stcp::monotonic_arena arena;
+                dynamic_segment_tree_case<stcp::dynamic_segment_tree<u64, sum::op, sum::e, stcp::arena_allocator<u64>>>(
+                    s, "dynamic_segment_tree<arena>", w, n, stcp::arena_allocator<u64>(arena));
+            }
+
+            if (n <= trie_max_n) {
+                binary_trie_array_case<stcp::binary_trie_array<trie_bits>>(s, "binary_trie_array", w, n);
+
+                stcp::monotonic_arena arena;
+                binary_trie_array_case<stcp::binary_trie_array<trie_bits, false, stcp::arena_allocator<std::byte>>>(
+                    s, "binary_trie_array<arena>", w, n, stcp::arena_allocator<std::byte>(arena));
+            }
+        }
+    }
+}
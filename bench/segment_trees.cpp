@@ -0,0 +1,123 @@
+// segment_tree, static_segment_tree, lazy_segment_tree, dual_segment_tree の点更新・区間積・区間作用
+
+#include <vector>
+#include <type_traits>
+#include <cstdint>
+#include "bench.hpp"
+#include <stcp/monoid.hpp>
+#include <stcp/segment_tree.hpp>
+#include <stcp/static_segment_tree.hpp>
+#include <stcp/lazy_segment_tree.hpp>
+#include <stcp/dual_segment_tree.hpp>
+using namespace std;
+
+// 作用の合成で桁あふれしても未定義動作にならないよう符号なしで持つ
+using u64 = uint64_t;
+using sum = stcp::sum_monoid<u64>;
+using mn = stcp::min_monoid<u64>;
+using sum_size = stcp::sum_size_monoid<u64>;
+using add_sum = stcp::add_sum_action<u64>;
+using add = stcp::add_action<u64>;
+using affine = stcp::affine_action<u64>;
+
+template <typename Tree>
+void point_update_range_prod(bench::suite &s, const char *name, bench::workload w, size_t n) {
+    auto q = s.queries();
+    auto is = bench::indices(w, n, q);
+    auto rs = bench::ranges(w, n, q);
+
+    s.begin();
+    // static_segment_tree は要素数を型で決める
+    auto seg = [&] {
+        if constexpr (is_constructible_v<Tree, size_t>) {
+            return Tree(n);
+        }
+        else {
+            return Tree();
+        }
+    }();
+    s.measure(string(name) + "::set", w, n, q, [&] {
+        for (size_t i = 0; i < q; ++i) {
+            seg.set(is[i], u64(i));
+        }
+        return seg.all_prod();
+    });
+    s.measure(string(name) + "::prod", w, n, q, [&] {
+        u64 acc = 0;
+        for (auto [l, r] : rs) {
+            acc += seg.prod(l, r);
+        }
+        return acc;
+    });
+}
+
+template <typename Tree, typename F>
+void range_apply_range_prod(bench::suite &s, const char *name, bench::workload w, size_t n, F f) {
+    auto q = s.queries();
+    auto as = bench::ranges(w, n, q, 3);
+    auto rs = bench::ranges(w, n, q);
+
+    s.begin();
+    Tree seg(vector<stcp::sum_size<u64>>(n, { 0, 1 }));
+    s.measure(string(name) + "::apply", w, n, q, [&] {
+        for (size_t i = 0; i < q; ++i) {
+            seg.apply(as[i].first, as[i].second, f(i));
+        }
+        return seg.all_prod().sum;
+    });
+    s.measure(string(name) + "::prod", w, n, q, [&] {
+        u64 acc = 0;
+        for (auto [l, r] : rs) {
+            acc += seg.prod(l, r).sum;
+        }
+        return acc;
+    });
+}
+
+template <typename Tree>
+void range_apply_point_get(bench::suite &s, const char *name, bench::workload w, size_t n) {
+    auto q = s.queries();
+    auto as = bench::ranges(w, n, q, 3);
+    auto is = bench::indices(w, n, q);
+
+    s.begin();
+    Tree seg(vector<u64>(n, 0));
+    s.measure(string(name) + "::apply", w, n, q, [&] {
+        for (size_t i = 0; i < q; ++i) {
+            seg.apply(as[i].first, as[i].second, u64(i));
+        }
+        return seg.get(0);
+    });
+    s.measure(string(name) + "::get", w, n, q, [&] {
+        u64 acc = 0;
+        for (auto i : is) {
+            acc += seg.get(i);
+        }
+        return acc;
+    });
+}
+
+int main(int argc, char **argv) {
+    bench::suite s("segment_trees", argc, argv);
+
+    for (auto n : s.sizes()) {
+        for (auto w : bench::workloads) {
+            point_update_range_prod<stcp::segment_tree<u64, sum::op, sum::e>>(s, "segment_tree<sum>", w, n);
+            point_update_range_prod<stcp::segment_tree_of<mn>>(s, "segment_tree<min>", w, n);
+
+            range_apply_range_prod<stcp::lazy_segment_tree<stcp::sum_size<u64>, sum_size::op, sum_size::e, u64, add_sum::mapping, add_sum::composition, add_sum::id>>(
+                s, "lazy_segment_tree<add_sum>", w, n, [](size_t i) { return u64(i); });
+            range_apply_range_prod<stcp::lazy_segment_tree<stcp::sum_size<u64>, sum_size::op, sum_size::e, stcp::affine<u64>, affine::mapping, affine::composition, affine::id>>(
+                s, "lazy_segment_tree<affine>", w, n, [](size_t i) { return stcp::affine<u64>{ u64(i % 3), u64(i) }; });
+
+            range_apply_point_get<stcp::dual_segment_tree_of<add>>(s, "dual_segment_tree<add>", w, n);
+        }
+    }
+
+    // 小さい固定長の木は, 同じ大きさの segment_tree と並べて測る
+    constexpr size_t static_n = 4096;
+    for (auto w : bench::workloads) {
+        point_update_range_prod<stcp::static_segment_tree<u64, sum::op, sum::e, static_n>>(s, "static_segment_tree<sum>", w, static_n);
+        point_update_range_prod<stcp::segment_tree<u64, sum::op, sum::e>>(s, "segment_tree<sum>", w, static_n);
+    }
+}
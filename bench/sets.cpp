@@ -0,0 +1,148 @@
+// 区間の集合と [0, n) の部分集合: segment_set (std::map / flat_map / arena), dense_segment_set, interval_map, fast_set
+
+#include <vector>
+#include <utility>
+#include <memory>
+#include <cstdint>
+#include "bench.hpp"
+#include <stcp/arena.hpp>
+#include <stcp/fast_set.hpp>
+#include <stcp/segment_set.hpp>
+#include <stcp/dense_segment_set.hpp>
+#include <stcp/interval_map.hpp>
+using namespace std;
+
+using u64 = uint64_t;
+
+// dense_segment_set は大きさを型で決めるので, これより大きい n は飛ばす
+constexpr size_t dense_n = size_t(1) << 20;
+
+// 長さ 1 から 16 の短い区間 (集合が 1 つの区間に潰れないようにする)
+vector<pair<size_t, size_t>> short_ranges(bench::workload w, size_t n, size_t q, uint64_t seed) {
+    auto is = bench::indices(w, n, q, seed);
+
+    vector<pair<size_t, size_t>> v(q);
+    for (size_t i = 0; i < q; ++i) {
+        v[i] = { is[i], min(n, is[i] + 1 + i % 16) };
+    }
+    return v;
+}
+
+template <typename Set>
+void segment_set_case(bench::suite &s, const char *name, bench::workload w, size_t n, Set &set) {
+    auto q = s.queries();
+    auto ins = short_ranges(w, n, q, 1), del = short_ranges(w, n, q, 2);
+    auto ks = bench::indices(w, n, q, 3);
+
+    s.measure(string(name) + "::insert", w, n, q, [&] {
+        for (auto [l, r] : ins) {
+            set.insert(l, r);
+        }
+        return set.wrapped_size(ins.back().first);
+    });
+    s.measure(string(name) + "::wrapped", w, n, q, [&] {
+        size_t acc = 0;
+        for (auto k : ks) {
+            if (auto x = set.wrapped(k)) {
+                acc += x->second - x->first;
+            }
+        }
+        return acc;
+    });
+    s.measure(string(name) + "::clear", w, n, q, [&] {
+        for (auto [l, r] : del) {
+            set.clear(l, r);
+        }
+        return set.wrapped_size(ins.back().first);
+    });
+}
+
+void interval_map_case(bench::suite &s, bench::workload w, size_t n) {
+    auto q = s.queries();
+    auto as = short_ranges(w, n, q, 1);
+    auto ks = bench::indices(w, n, q, 3);
+
+    s.begin();
+    stcp::interval_map<u64, u64> map;
+    s.measure("interval_map::assign", w, n, q, [&] {
+        for (size_t i = 0; i < q; ++i) {
+            map.assign(as[i].first, as[i].second, i % 4);
+        }
+        return map.size();
+    });
+    s.measure("interval_map::get", w, n, q, [&] {
+        u64 acc = 0;
+        for (auto k : ks) {
+            acc += map.get(k).value_or(0);
+        }
+        return acc;
+    });
+}
+
+void fast_set_case(bench::suite &s, bench::workload w, size_t n) {
+    auto q = s.queries();
+    auto ins = bench::indices(w, n, q, 1), del = bench::indices(w, n, q, 2);
+    auto ks = bench::indices(w, n, q, 3);
+
+    s.begin();
+    stcp::fast_set set(n);
+    s.measure("fast_set::set", w, n, q, [&] {
+        for (auto k : ins) {
+            set.set(k);
+        }
+        return set.test(0);
+    });
+    s.measure("fast_set::next", w, n, q, [&] {
+        size_t acc = 0;
+        for (auto k : ks) {
+            acc += set.next(k);
+        }
+        return acc;
+    });
+    s.measure("fast_set::prev", w, n, q, [&] {
+        size_t acc = 0;
+        for (auto k : ks) {
+            acc += set.prev(k);
+        }
+        return acc;
+    });
+    s.measure("fast_set::reset", w, n, q, [&] {
+        for (auto k : del) {
+            set.reset(k);
+        }
+        return set.test(0);
+    });
+}
+
+int main(int argc, char **argv) {
+    bench::suite s("sets", argc, argv);
+
+    for (auto n : s.sizes()) {
+        for (auto w : bench::workloads) {
+            {
+                s.begin();
+                stcp::segment_set<u64> set;
+                segment_set_case(s, "segment_set", w, n, set);
+            }
+            {
+                s.begin();
+                stcp::flat_segment_set<u64> set;
+                segment_set_case(s, "flat_segment_set", w, n, set);
+            }
+            {
+                s.begin();
+                stcp::monotonic_arena arena;
+                stcp::arena_segment_set<u64> set(arena);
+                segment_set_case(s, "arena_segment_set", w, n, set);
+            }
+            if (n <= dense_n) {
+                s.begin();
+                auto set = make_unique<stcp::dense_segment_set<dense_n>>();
+                segment_set_case(s, "dense_segment_set", w, n, *set);
+            }
+
+            interval_map_case(s, w, n);
+            fast_set_case(s, w, n);
+        }
+    }
+}
@@ -0,0 +1,34 @@
+// https://atcoder.jp/contests/abc167/tasks/abc167_d
+
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <stcp/functional_graph_cycle.hpp>
+using namespace std;
+
+// 位置だけを求めるので自明な群
+struct unit {
+};
+unit op(unit, unit) {
+    return {};
+}
+unit e() {
+    return {};
+}
+unit inv(unit) {
+    return {};
+}
+
+int main() {
+    int n; cin >> n;
+    uint64_t k; cin >> k;
+
+    vector<int> a(n);
+    for (auto &e : a) {
+        cin >> e; --e;
+    }
+
+    stcp::functional_graph_cycle<int, unit, op, e, inv> graph(a, vector<unit>(n));
+
+    cout << graph.next(0, k) + 1 << endl;
+}
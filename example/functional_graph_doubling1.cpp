@@ -0,0 +1,37 @@
+// https://atcoder.jp/contests/abc179/tasks/abc179_e
+
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <stcp/functional_graph_doubling.hpp>
+using namespace std;
+
+int64_t op(int64_t x, int64_t y) {
+    return x + y;
+}
+int64_t e() {
+    return 0;
+}
+
+int main() {
+    int64_t n; cin >> n;
+    int x, m; cin >> x >> m;
+
+    int log2 = 0;
+    while ((int64_t(1) << (log2 + 1)) <= n) {
+        ++log2;
+    }
+
+    vector<uint32_t> next(m);
+    vector<int64_t> value(m);
+    for (int64_t i = 0; i < m; ++i) {
+        next[i] = (i * i) % m;
+        value[i] = i;
+    }
+
+    stcp::functional_graph_doubling<uint32_t, int64_t, op, e> dub(log2, next, value);
+
+    auto [_, ans] = dub.jump(x, n);
+
+    cout << ans << endl;
+}
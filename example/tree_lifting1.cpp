@@ -0,0 +1,58 @@
+// https://judge.yosupo.jp/problem/jump_on_tree
+
+#include <iostream>
+#include <vector>
+#include <stcp/tree_lifting.hpp>
+using namespace std;
+
+int op(int x, int y) {
+    return x + y;
+}
+int e() {
+    return 0;
+}
+
+int main() {
+    ios::sync_with_stdio(false); cin.tie(nullptr);
+
+    int n, q; cin >> n >> q;
+
+    vector<vector<int>> g(n);
+    for (int i = 0; i < n - 1; ++i) {
+        int a, b; cin >> a >> b;
+        g[a].push_back(b);
+        g[b].push_back(a);
+    }
+
+    // 頂点 0 を根にする
+    vector<int> parent(n, -1), stack{ 0 };
+    parent[0] = 0;
+    while (!stack.empty()) {
+        auto v = stack.back(); stack.pop_back();
+        for (auto u : g[v]) {
+            if (parent[u] == -1) {
+                parent[u] = v;
+                stack.push_back(u);
+            }
+        }
+    }
+
+    stcp::tree_lifting<int, int, op, e> tree(parent, vector<int>(n, 1), true);
+
+    while (q--) {
+        int s, t, i; cin >> s >> t >> i;
+
+        auto w = tree.lca(s, t);
+        size_t ds = tree.depth(s) - tree.depth(w), dt = tree.depth(t) - tree.depth(w);
+
+        if (ds + dt < size_t(i)) {
+            cout << -1 << '\n';
+        }
+        else if (size_t(i) <= ds) {
+            cout << tree.ancestor(s, i) << '\n';
+        }
+        else {
+            cout << tree.ancestor(t, ds + dt - i) << '\n';
+        }
+    }
+}
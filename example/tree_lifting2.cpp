@@ -0,0 +1,71 @@
+// https://atcoder.jp/contests/abc235/tasks/abc235_e
+
+#include <iostream>
+#include <vector>
+#include <tuple>
+#include <numeric>
+#include <algorithm>
+#include <cstdint>
+#include <stcp/tree_lifting.hpp>
+using namespace std;
+
+int64_t op(int64_t x, int64_t y) {
+    return max(x, y);
+}
+int64_t e() {
+    return 0;
+}
+
+int main() {
+    ios::sync_with_stdio(false); cin.tie(nullptr);
+
+    int n, m, q; cin >> n >> m >> q;
+
+    vector<tuple<int64_t, int, int>> edges(m);
+    for (auto &[c, a, b] : edges) {
+        cin >> a >> b >> c; --a; --b;
+    }
+    sort(edges.begin(), edges.end());
+
+    // Kruskal 法で最小全域木を作る
+    vector<int> uf(n);
+    iota(uf.begin(), uf.end(), 0);
+    auto find = [&](int v) {
+        while (uf[v] != v) {
+            v = uf[v] = uf[uf[v]];
+        }
+        return v;
+    };
+
+    vector<vector<pair<int, int64_t>>> g(n);
+    for (auto [c, a, b] : edges) {
+        if (auto x = find(a), y = find(b); x != y) {
+            uf[x] = y;
+            g[a].emplace_back(b, c);
+            g[b].emplace_back(a, c);
+        }
+    }
+
+    // 頂点 0 を根にし, 親への辺の重みを weight に置く
+    vector<int> parent(n, -1), stack{ 0 };
+    vector<int64_t> weight(n, e());
+    parent[0] = 0;
+    while (!stack.empty()) {
+        auto v = stack.back(); stack.pop_back();
+        for (auto [u, c] : g[v]) {
+            if (parent[u] == -1) {
+                parent[u] = v;
+                weight[u] = c;
+                stack.push_back(u);
+            }
+        }
+    }
+
+    stcp::compact_tree_lifting<int, int64_t, op, e> tree(parent, weight);
+
+    // 辺 (u, v, w) はパス上の最大の重みより軽ければ最小全域木に入る
+    while (q--) {
+        int u, v; int64_t w; cin >> u >> v >> w; --u; --v;
+        cout << (w < tree.prod(u, v) ? "Yes" : "No") << '\n';
+    }
+}
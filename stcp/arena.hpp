@@ -0,0 +1,151 @@
+#ifndef STCP_ARENA_HPP
+#define STCP_ARENA_HPP
+
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace stcp {
+    // 大きなブロックから前詰めで切り出すだけのメモリ領域
+    // 個別には解放せず, reset で確保済みのブロックを先頭から使い直す
+    struct monotonic_arena {
+        // O(1)
+        explicit monotonic_arena(std::size_t block_size = std::size_t(1) << 20) noexcept:
+            block_size_(std::max<std::size_t>(block_size, 64)), block_(0), cur_(nullptr), end_(nullptr) {
+        }
+
+        monotonic_arena(const monotonic_arena &) = delete;
+        monotonic_arena &operator=(const monotonic_arena &) = delete;
+
+    public:
+        // 償却 O(1)
+        // align は 2 の冪
+        void *allocate(std::size_t bytes, std::size_t align) {
+            assert(0 < align && (align & (align - 1)) == 0);
+
+            auto p = align_up(cur_, align);
+            if (cur_ == nullptr || end_ < p || std::size_t(end_ - p) < bytes) {
+                p = next_block(bytes, align);
+            }
+
+            cur_ = p + bytes;
+            return p;
+        }
+
+        // O(1)
+        // これまでに切り出した領域をすべて無効にする (ブロックは手放さない)
+        void reset() noexcept {
+            block_ = 0;
+            if (blocks_.empty()) {
+                cur_ = end_ = nullptr;
+                return;
+            }
+            cur_ = blocks_[0].first.get();
+            end_ = cur_ + blocks_[0].second;
+        }
+
+        // O(ブロック数)
+        // 確保済みのブロックの合計バイト数
+        std::size_t capacity() const noexcept {
+            std::size_t sum = 0;
+            for (auto &[p, n] : blocks_) {
+                sum += n;
+            }
+            return sum;
+        }
+
+    private:
+        static char *align_up(char *p, std::size_t align) noexcept {
+            auto x = reinterpret_cast<std::uintptr_t>(p);
+            return p + ((align - x % align) % align);
+        }
+
+        // bytes を align 境界から置ける次のブロックへ移る (なければ確保する)
+        char *next_block(std::size_t bytes, std::size_t align) {
+            auto need = bytes + align;
+
+            if (cur_ != nullptr) {
+                ++block_;
+            }
+            while (block_ < blocks_.size() && blocks_[block_].second < need) {
+                ++block_;
+            }
+
+            if (block_ == blocks_.size()) {
+                auto n = std::max(block_size_, need);
+                // make_unique は全体を 0 で埋めるので, 初期化しない new[] で確保する
+                blocks_.emplace_back(std::unique_ptr<char[]>(new char[n]), n);
+                block_size_ *= 2;
+            }
+
+            cur_ = blocks_[block_].first.get();
+            end_ = cur_ + blocks_[block_].second;
+
+            return align_up(cur_, align);
+        }
+
+    private:
+        std::size_t block_size_;
+        std::vector<std::pair<std::unique_ptr<char[]>, std::size_t>> blocks_;
+        std::size_t block_;
+        char *cur_, *end_;
+    };
+
+    // monotonic_arena から切り出すアロケータ (deallocate は何もしない)
+    template <typename T>
+    struct arena_allocator {
+        using value_type = T;
+
+        arena_allocator(monotonic_arena &arena) noexcept:
+            arena_(&arena) {
+        }
+
+        template <typename U>
+        arena_allocator(const arena_allocator<U> &other) noexcept:
+            arena_(other.arena()) {
+        }
+
+    public:
+        T *allocate(std::size_t n) {
+            return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *, std::size_t) noexcept {
+        }
+
+        monotonic_arena *arena() const noexcept {
+            return arena_;
+        }
+
+        template <typename U>
+        friend bool operator==(const arena_allocator &x, const arena_allocator<U> &y) noexcept {
+            return x.arena() == y.arena();
+        }
+        template <typename U>
+        friend bool operator!=(const arena_allocator &x, const arena_allocator<U> &y) noexcept {
+            return x.arena() != y.arena();
+        }
+
+    private:
+        monotonic_arena *arena_;
+    };
+
+    // 解放が何もしないアロケータか
+    // 節点が自明に破棄できるなら, 木の破棄で節点をたどる必要がない
+    template <typename Allocator>
+    struct is_monotonic_allocator: std::false_type {
+    };
+    template <typename T>
+    struct is_monotonic_allocator<arena_allocator<T>>: std::true_type {
+    };
+
+    template <typename Allocator>
+    constexpr bool is_monotonic_allocator_v = is_monotonic_allocator<Allocator>::value;
+}
+
+#endif // STCP_ARENA_HPP
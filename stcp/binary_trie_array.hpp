@@ -3,20 +3,46 @@
 
 #include <type_traits>
 #include <utility>
+#include <algorithm>
+#include <vector>
+#include <tuple>
+#include <memory>
 #include <stdexcept>
 #include <cassert>
 #include <cstddef>
+#include "stcp/arena.hpp"
+#include "stcp/stats.hpp"
 
 namespace stcp {
-    template <std::size_t Bits>
-    struct binary_trie_array {
+    // Sum = true のとき各節点が添字ごとのビット別個数を持ち, sum_smallest が使える
+    // トライと内側の木の節点はすべて Allocator (を rebind したもの) で確保する
+    // STCP_ENABLE_STATS のとき stats() でトライと内側の木を合わせた Op の呼び出し・節点の訪問・確保の回数を返す
+    template <std::size_t Bits, bool Sum = false, typename Allocator = std::allocator<std::byte>>
+    struct binary_trie_array: stats_recorder<binary_trie_array<Bits, Sum, Allocator>> {
         static_assert(0 < Bits);
 
         constexpr static std::size_t bits = Bits;
 
+        using allocator_type = Allocator;
+
         // O(1)
-        binary_trie_array(std::size_t max_range_) noexcept:
-            xor_all{ 0 }, max_range(max_range_), root(max_range_) {
+        binary_trie_array(std::size_t max_range_, const Allocator &alloc = Allocator()) noexcept:
+            xor_all{ 0 }, max_range(max_range_), root(max_range_, alloc) {
+        }
+
+        // O(Bits size(v))
+        // 0 <= v[k] < 2^Bits
+        explicit binary_trie_array(const std::vector<std::size_t> &v, const Allocator &alloc = Allocator()):
+            binary_trie_array(v.size(), alloc) {
+            build_(v);
+        }
+
+        // O(節点数) (arena_allocator なら O(1))
+        // 全ての値を取り除き, apply_xor の累積も 0 に戻す
+        void clear() {
+            xor_all = 0;
+            root.release();
+            root.iset.clear();
         }
 
         // O(1)
@@ -89,6 +115,7 @@ namespace stcp {
 
             const node *iter = &root; 
             while (0 < b) {
+                recorder::count_visit();
                 auto m = !!(xor_all & b);
                 auto c = iter->c[m];
                 b >>= 1; path <<= 1;
@@ -109,6 +136,51 @@ namespace stcp {
             return path;
         }
 
+        // O(Bits^2 log max_range)
+        // 0 <= n <= size(l, r)
+        // [l, r) に含まれる値のうち小さい方から n 個の和
+        std::size_t sum_smallest(std::size_t l, std::size_t r, std::size_t n) const {
+            static_assert(Sum, "stcp::binary_trie_array requires Sum = true");
+
+            assert(l <= r && r <= max_range);
+
+            if (size(l, r) < n) {
+                throw std::out_of_range("binary_trie_array");
+            }
+
+            std::size_t path = 0, sum = 0;
+
+            auto b = (std::size_t(1) << (Bits - 1));
+
+            const node *iter = &root;
+            while (0 < b && 0 < n) {
+                recorder::count_visit();
+                auto m = !!(xor_all & b);
+                auto c = iter->c[m];
+                b >>= 1; path <<= 1;
+
+                if (c != nullptr) {
+                    auto x = c->iset.prod(l, r);
+                    if (n < std::size_t(x.n)) {
+                        iter = c;
+                        path |= 0;
+                        continue;
+                    }
+                    n -= x.n;
+                    sum += sum_of(x);
+                }
+
+                iter = iter->c[!m];
+                path |= 1;
+            }
+
+            if (0 < n) {
+                sum += n * path;
+            }
+
+            return sum;
+        }
+
         // O(Bits log max_range)
         // 0 <= v < 2^Bits
         std::size_t lower_bound(std::size_t l, std::size_t r, std::size_t v) const noexcept {
@@ -131,6 +203,7 @@ namespace stcp {
 
             const node *iter = &root;
             while (0 < b) {
+                recorder::count_visit();
                 auto m = !!(xor_all & b);
                 auto f = !!(v & b);
                 auto c = iter->c[m];
@@ -152,38 +225,147 @@ namespace stcp {
             return sum;
         }
 
+        using query_type = std::tuple<std::size_t, std::size_t, std::size_t>;
+
+        // O(Bits size(qs) log max_range)
+        // qs[i] = (l, r, n), 0 <= n < size(l, r)
+        // 各段の節点を一度ずつ訪れるように全クエリを同時に降ろす
+        std::vector<std::size_t> nth_element(const std::vector<query_type> &qs) const {
+            std::vector<std::size_t> path(qs.size(), 0), rest(qs.size());
+            for (std::size_t i = 0; i < qs.size(); ++i) {
+                auto [l, r, n] = qs[i];
+                assert(l <= r && r <= max_range);
+
+                if (size(l, r) <= n) {
+                    throw std::out_of_range("binary_trie_array");
+                }
+                rest[i] = n;
+            }
+
+            descend_(qs.size(), [&](std::size_t b, const node *iter, std::size_t i) {
+                auto [l, r, _] = qs[i];
+                auto m = !!(xor_all & b);
+                auto c = iter->c[m];
+                path[i] <<= 1;
+
+                if (c != nullptr) {
+                    auto k = c->count(l, r);
+                    if (rest[i] < k) {
+                        return int(m);
+                    }
+                    rest[i] -= k;
+                }
+
+                path[i] |= 1;
+                return int(!m);
+            }, [](const node *, std::size_t) {
+            });
+
+            return path;
+        }
+
+        // O(Bits size(qs) log max_range)
+        // qs[i] = (l, r, v), 0 <= v < 2^Bits
+        std::vector<std::size_t> lower_bound(std::vector<query_type> qs) const {
+            std::vector<std::size_t> zero;
+            for (std::size_t i = 0; i < qs.size(); ++i) {
+                auto &v = std::get<2>(qs[i]);
+                if (v == 0) {
+                    zero.push_back(i);
+                    continue;
+                }
+                --v;
+            }
+
+            auto res = upper_bound(qs);
+            for (auto i : zero) {
+                res[i] = 0;
+            }
+
+            return res;
+        }
+
+        // O(Bits size(qs) log max_range)
+        // qs[i] = (l, r, v), 0 <= v < 2^Bits
+        std::vector<std::size_t> upper_bound(const std::vector<query_type> &qs) const {
+            std::vector<std::size_t> sum(qs.size(), 0);
+
+            descend_(qs.size(), [&](std::size_t b, const node *iter, std::size_t i) {
+                auto [l, r, v] = qs[i];
+                assert(l <= r && r <= max_range);
+
+                auto m = !!(xor_all & b);
+                auto f = !!(v & b);
+                auto c = iter->c[m];
+
+                if (c != nullptr && f) {
+                    sum[i] += c->count(l, r);
+                }
+
+                if (iter->c[m ^ f] == nullptr) {
+                    return -1;
+                }
+                return int(m ^ f);
+            }, [&](const node *iter, std::size_t i) {
+                auto [l, r, _] = qs[i];
+                sum[i] += iter->count(l, r);
+            });
+
+            return sum;
+        }
+
     private:
-        template <typename S, S (*Op)(S, S), S (*E)()>
-        struct dynamic_segment_tree {
+        // 内側の木の回数は binary_trie_array の stats() に合算する
+        template <typename S, S (*Op)(S, S), S (*E)(), typename Alloc>
+        struct dynamic_segment_tree: stats_recorder<binary_trie_array> {
             using value_type = S;
+            using allocator_type = Alloc;
 
             // O(1)
-            dynamic_segment_tree() noexcept:
-                dynamic_segment_tree(0) {
+            dynamic_segment_tree(std::size_t n, const Alloc &alloc) noexcept:
+                n_(n), root_(nullptr), alloc_(alloc) {
             }
 
-            // O(1)
-            dynamic_segment_tree(std::size_t n) noexcept:
-                n_(n), root_(nullptr) {
-            }
+            dynamic_segment_tree(const dynamic_segment_tree &) = delete;
+            dynamic_segment_tree &operator =(const dynamic_segment_tree &) = delete;
 
             ~dynamic_segment_tree() {
-                if (root_ != nullptr) delete root_;
+                release();
             }
 
         public:
+            // O(節点数) (arena_allocator なら O(1))
+            void clear() {
+                release();
+            }
+
+            allocator_type get_allocator() const noexcept {
+                return allocator_type(alloc_);
+            }
+
             // O(log size(dynamic_segment_tree))
             // 0 <= i < size(dynamic_segment_tree)
             void set(std::size_t i, S x) {
-                assert(0 <= i && i < n_);
+                assert(i < n_);
 
                 update_tree(root_, 0, n_, i, x);
             }
 
+            // O(last - first)
+            // [first, last) は狭義単調増加な添字列, 空の木に対してのみ呼べる
+            // 添字 i には f(i) を置く
+            template <typename F>
+            void build(const std::size_t *first, const std::size_t *last, F f) {
+                assert(root_ == nullptr);
+                assert(first == last || last[-1] < n_);
+
+                root_ = build_tree(first, last, 0, n_, f);
+            }
+
             // O(log size(dynamic_segment_tree))
             // 0 <= i < size(dynamic_segment_tree)
             S get(std::size_t i) const {
-                assert(0 <= i && i < n_);
+                assert(i < n_);
 
                 return get(root_, 0, n_, i);
             }
@@ -196,7 +378,7 @@ namespace stcp {
             // O(log size(dynamic_segment_tree))
             // 0 <= l <= r <= size(dynamic_segment_tree)
             S prod(std::size_t l, std::size_t r) const {
-                assert(0 <= l && l <= r && r <= n_);
+                assert(l <= r && r <= n_);
 
                 return prod(root_, 0, n_, l, r);
             }
@@ -215,7 +397,7 @@ namespace stcp {
             std::size_t max_right(std::size_t l, F &&f) const {
                 static_assert(std::is_invocable_r_v<bool, F, S>);
 
-                assert(0 <= l && l <= n_);
+                assert(l <= n_);
                 assert(std::forward<F>(f)(E()));
 
                 S acc = E();
@@ -230,7 +412,7 @@ namespace stcp {
             std::size_t min_left(std::size_t r, F &&f) const {
                 static_assert(std::is_invocable_r_v<bool, F, S>);
 
-                assert(0 <= r && r <= n_);
+                assert(r <= n_);
                 assert(std::forward<F>(f)(E()));
 
                 S acc = E();
@@ -240,18 +422,20 @@ namespace stcp {
             }
 
         private:
+            using recorder = stats_recorder<binary_trie_array>;
+
+            static S op(S x, S y) {
+                recorder::count_op();
+                return Op(x, y);
+            }
+
             struct node {
                 node(std::size_t i, S value):
                     i(i), value(value), prod(value), l(nullptr), r(nullptr) {
                 }
 
-                ~node() {
-                    if (l != nullptr) delete l;
-                    if (r != nullptr) delete r;
-                }
-
                 void update() {
-                    prod = Op(Op(
+                    prod = op(op(
                         l != nullptr ? l->prod : E(),
                         value),
                         r != nullptr ? r->prod : E()
@@ -263,13 +447,43 @@ namespace stcp {
                 node *l, *r;
             };
 
-            static void update_tree(node* &range, std::size_t l, std::size_t r, std::size_t i, S x) {
+            using node_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+            using node_traits = std::allocator_traits<node_allocator>;
+
+            node *create_node(std::size_t i, S x) {
+                recorder::count_allocation();
+                auto range = node_traits::allocate(alloc_, 1);
+                node_traits::construct(alloc_, range, i, x);
+                return range;
+            }
+
+            void destroy_tree(node *range) {
+                if (range == nullptr) {
+                    return;
+                }
+
+                destroy_tree(range->l);
+                destroy_tree(range->r);
+
+                node_traits::destroy(alloc_, range);
+                node_traits::deallocate(alloc_, range, 1);
+            }
+
+            void release() {
+                if constexpr (!(is_monotonic_allocator_v<Alloc> && std::is_trivially_destructible_v<S>)) {
+                    destroy_tree(root_);
+                }
+                root_ = nullptr;
+            }
+
+            void update_tree(node* &range, std::size_t l, std::size_t r, std::size_t i, S x) {
                 using std::swap;
 
                 if (range == nullptr) {
-                    range = new node(i, x);
+                    range = create_node(i, x);
                     return;
                 }
+                recorder::count_visit();
 
                 if (range->i == i) {
                     range->value = x;
@@ -296,10 +510,32 @@ namespace stcp {
                 range->update();
             }
 
+            template <typename F>
+            node *build_tree(const std::size_t *first, const std::size_t *last, std::size_t l, std::size_t r, F &f) {
+                if (first == last) {
+                    return nullptr;
+                }
+
+                auto m = l + (r - l) / 2;
+
+                auto iter = std::lower_bound(first, last, m);
+                if (iter != first) {
+                    --iter;
+                }
+
+                auto range = create_node(*iter, f(*iter));
+                range->l = build_tree(first, iter, l, m, f);
+                range->r = build_tree(iter + 1, last, m, r, f);
+                range->update();
+
+                return range;
+            }
+
             static S get(const node *range, std::size_t l, std::size_t r, std::size_t i) noexcept {
                 if (range == nullptr) {
                     return E();
                 }
+                recorder::count_visit();
 
                 if (range->i == i) {
                     return range->value;
@@ -316,6 +552,7 @@ namespace stcp {
                 if (range == nullptr || r <= query_l || query_r <= l) {
                     return E();
                 }
+                recorder::count_visit();
 
                 if (query_l <= l && r <= query_r) {
                     return range->prod;
@@ -325,9 +562,9 @@ namespace stcp {
 
                 S acc = prod(range->l, l, m, query_l, query_r);
                 if (query_l <= range->i && range->i < query_r) {
-                    acc = Op(acc, range->value);
+                    acc = op(acc, range->value);
                 }
-                return Op(acc, prod(range->r, m, r, query_l, query_r));
+                return op(acc, prod(range->r, m, r, query_l, query_r));
             }
 
             template <typename F>
@@ -335,6 +572,7 @@ namespace stcp {
                 if (range == nullptr || r <= query_l) {
                     return r;
                 }
+                recorder::count_visit();
 
                 auto m = l + (r - l) / 2;
 
@@ -344,7 +582,7 @@ namespace stcp {
                 }
 
                 if (query_l <= range->i) {
-                    if (S con = Op(acc, range->value); f(con)) {
+                    if (S con = op(acc, range->value); f(con)) {
                         acc = con;
                     }
                     else {
@@ -357,7 +595,7 @@ namespace stcp {
                         return r;
                     }
 
-                    if (S con = Op(acc, range->r->prod); f(con)) {
+                    if (S con = op(acc, range->r->prod); f(con)) {
                         acc = con;
                         return r;
                     }
@@ -371,6 +609,7 @@ namespace stcp {
                 if (range == nullptr || query_r <= l) {
                     return l;
                 }
+                recorder::count_visit();
 
                 auto m = l + (r - l) / 2;
 
@@ -380,7 +619,7 @@ namespace stcp {
                 }
 
                 if (range->i < query_r) {
-                    if (S con = Op(range->value, acc); f(con)) {
+                    if (S con = op(range->value, acc); f(con)) {
                         acc = con;
                     }
                     else {
@@ -393,7 +632,7 @@ namespace stcp {
                         return l;
                     }
 
-                    if (S con = Op(range->l->prod, acc); f(con)) {
+                    if (S con = op(range->l->prod, acc); f(con)) {
                         acc = con;
                         return l;
                     }
@@ -405,6 +644,7 @@ namespace stcp {
         private:
             std::size_t n_;
             node *root_;
+            node_allocator alloc_;
         };
 
         static constexpr int op(int x, int y) noexcept {
@@ -414,38 +654,108 @@ namespace stcp {
             return 0;
         }
 
-        using segtree = dynamic_segment_tree<int, op, elem>;
+        // n: 個数, bit[j]: j ビット目が立っている値の個数
+        struct bit_count {
+            int n;
+            int bit[Bits];
+        };
+
+        static constexpr bit_count bit_op(bit_count x, bit_count y) noexcept {
+            x.n += y.n;
+            for (std::size_t j = 0; j < Bits; ++j) {
+                x.bit[j] += y.bit[j];
+            }
+            return x;
+        }
+        static constexpr bit_count bit_elem() noexcept {
+            return bit_count{};
+        }
+
+        using count_type = std::conditional_t<Sum, bit_count, int>;
+        template <typename T>
+        using rebind_t = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+        using segtree = std::conditional_t<Sum,
+            dynamic_segment_tree<bit_count, bit_op, bit_elem, rebind_t<bit_count>>,
+            dynamic_segment_tree<int, op, elem, rebind_t<int>>
+        >;
+
+        static std::size_t size_of(int x) noexcept {
+            return x;
+        }
+        static std::size_t size_of(const bit_count &x) noexcept {
+            return x.n;
+        }
+
+        // 値 v を d 個加える
+        static int add(int x, int d, std::size_t) noexcept {
+            return x + d;
+        }
+        static bit_count add(bit_count x, int d, std::size_t v) noexcept {
+            x.n += d;
+            for (std::size_t j = 0; j < Bits; ++j) {
+                if ((v >> j) & 1) {
+                    x.bit[j] += d;
+                }
+            }
+            return x;
+        }
 
     private:
+        using recorder = stats_recorder<binary_trie_array>;
+
         struct node {
-            node(std::size_t max_range) noexcept:
-                iset(max_range), c{ nullptr, nullptr } {
+            using node_allocator = rebind_t<node>;
+            using node_traits = std::allocator_traits<node_allocator>;
+
+            node(std::size_t max_range, const Allocator &alloc) noexcept:
+                iset(max_range, alloc), c{ nullptr, nullptr } {
             }
 
+            node(const node &) = delete;
+            node &operator=(const node &) = delete;
+
             ~node() {
-                if (c[0] != nullptr) delete c[0];
-                if (c[1] != nullptr) delete c[1];
+                release();
+            }
+
+            // 子孫の節点を解放する
+            void release() {
+                if constexpr (!is_monotonic_allocator_v<Allocator>) {
+                    node_allocator alloc(iset.get_allocator());
+                    for (auto &d : c) {
+                        if (d != nullptr) {
+                            node_traits::destroy(alloc, d);
+                            node_traits::deallocate(alloc, d, 1);
+                        }
+                    }
+                }
+                c[0] = c[1] = nullptr;
             }
 
             node *advance(bool f) {
                 if (c[f] == nullptr) {
-                    c[f] = new node(iset.size());
+                    recorder::count_allocation();
+                    node_allocator alloc(iset.get_allocator());
+                    auto d = node_traits::allocate(alloc, 1);
+                    node_traits::construct(alloc, d, iset.size(), Allocator(iset.get_allocator()));
+                    c[f] = d;
                 }
                 return c[f];
             }
 
             std::size_t count(std::size_t l, std::size_t r) const {
-                return iset.prod(l, r);
+                return size_of(iset.prod(l, r));
             }
             std::size_t count() const {
-                return iset.all_prod();
+                return size_of(iset.all_prod());
             }
 
-            void insert(int index) {
-                iset.set(index, iset.get(index) + 1);
+            void insert(int index, std::size_t v) {
+                iset.set(index, add(iset.get(index), +1, v));
             }
-            void erase(int index) {
-                iset.set(index, iset.get(index) - 1);
+            void erase(int index, std::size_t v) {
+                iset.set(index, add(iset.get(index), -1, v));
             }
 
             segtree iset;
@@ -457,6 +767,7 @@ namespace stcp {
 
             const node *iter = &root;
             while (0 < b) {
+                recorder::count_visit();
                 iter = iter->c[!!(n & b)];
                 if (iter == nullptr || iter->count(l, r) == 0) {
                     return 0;
@@ -473,9 +784,10 @@ namespace stcp {
         void insert_(std::size_t k, std::size_t n) {
             auto b = (std::size_t(1) << (Bits - 1));
 
-            node *iter = &root; root.insert(k);
+            node *iter = &root; root.insert(k, n);
             while (0 < b) {
-                iter = iter->advance(!!(n & b)); iter->insert(k);
+                recorder::count_visit();
+                iter = iter->advance(!!(n & b)); iter->insert(k, n);
                 b >>= 1;
             }
         }
@@ -483,14 +795,121 @@ namespace stcp {
             if (exist_(k, k + 1, n)) {
                 auto b = (std::size_t(1) << (Bits - 1));
 
-                node *iter = &root; root.erase(k);
+                node *iter = &root; root.erase(k, n);
                 while (0 < b) {
-                    iter = iter->c[!!(n & b)]; iter->erase(k);
+                    recorder::count_visit();
+                    iter = iter->c[!!(n & b)]; iter->erase(k, n);
                     b >>= 1;
                 }
             }
         }
 
+        // xor_all を適用した値の総和
+        std::size_t sum_of(const bit_count &x) const noexcept {
+            std::size_t sum = 0;
+            for (std::size_t j = 0; j < Bits; ++j) {
+                std::size_t c = ((xor_all >> j) & 1) ? x.n - x.bit[j] : x.bit[j];
+                sum += c << j;
+            }
+            return sum;
+        }
+
+        void build_(const std::vector<std::size_t> &v) {
+            std::vector<std::size_t> ord(max_range), buf(max_range);
+            for (std::size_t k = 0; k < max_range; ++k) {
+                ord[k] = k;
+            }
+
+            root.iset.build(ord.data(), ord.data() + max_range, [&](std::size_t k) {
+                return add(count_type{}, 1, v[k]);
+            });
+            build_node(v, &root, ord.data(), ord.data() + max_range, buf.data(), std::size_t(1) << (Bits - 1));
+        }
+
+        // [first, last) を b の立っているかで安定に分割して子に割り当てる
+        static void build_node(const std::vector<std::size_t> &v, node *iter, std::size_t *first, std::size_t *last, std::size_t *buf, std::size_t b) {
+            if (b == 0 || first == last) {
+                return;
+            }
+
+            auto mid = first, rest = buf;
+            for (auto i = first; i != last; ++i) {
+                if (v[*i] & b) {
+                    *rest++ = *i;
+                }
+                else {
+                    *mid++ = *i;
+                }
+            }
+            std::copy(buf, rest, mid);
+
+            if (first != mid) {
+                iter->advance(0)->iset.build(first, mid, [&](std::size_t k) {
+                    return add(count_type{}, 1, v[k]);
+                });
+                build_node(v, iter->c[0], first, mid, buf, b >> 1);
+            }
+            if (mid != last) {
+                iter->advance(1)->iset.build(mid, last, [&](std::size_t k) {
+                    return add(count_type{}, 1, v[k]);
+                });
+                build_node(v, iter->c[1], mid, last, buf, b >> 1);
+            }
+        }
+
+        // q 個のクエリを根から一段ずつ降ろす
+        // step(b, iter, i) はクエリ i の進む子 (0 / 1) を返す, 負なら打ち切り
+        // 最下段まで到達したクエリには finish(iter, i) を呼ぶ
+        template <typename Step, typename Finish>
+        void descend_(std::size_t q, Step step, Finish finish) const {
+            std::vector<std::size_t> ord(q), buf(q);
+            for (std::size_t i = 0; i < q; ++i) {
+                ord[i] = i;
+            }
+
+            std::vector<std::tuple<const node *, std::size_t, std::size_t>> group, next;
+            if (0 < q) {
+                group.emplace_back(&root, 0, q);
+            }
+
+            auto b = (std::size_t(1) << (Bits - 1));
+            while (0 < b && !group.empty()) {
+                next.clear();
+
+                for (auto [iter, first, last] : group) {
+                    recorder::count_visit();
+                    auto mid = first, k = std::size_t(0);
+                    for (auto j = first; j < last; ++j) {
+                        auto i = ord[j];
+                        auto d = step(b, iter, i);
+                        if (d == 0) {
+                            ord[mid++] = i;
+                        }
+                        if (d == 1) {
+                            buf[k++] = i;
+                        }
+                    }
+                    std::copy(buf.begin(), buf.begin() + k, ord.begin() + mid);
+
+                    if (first < mid) {
+                        next.emplace_back(iter->c[0], first, mid);
+                    }
+                    if (0 < k) {
+                        next.emplace_back(iter->c[1], mid, mid + k);
+                    }
+                }
+
+                std::swap(group, next);
+                b >>= 1;
+            }
+
+            for (auto [iter, first, last] : group) {
+                for (auto j = first; j < last; ++j) {
+                    finish(iter, ord[j]);
+                }
+            }
+        }
+
         std::size_t xor_all;
         std::size_t max_range;
         node root;
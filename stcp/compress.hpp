@@ -0,0 +1,227 @@
+#ifndef STCP_COMPRESS_HPP
+#define STCP_COMPRESS_HPP
+
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+#include <vector>
+#include <limits>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace stcp {
+    // 整数を符号なしの順序を保つ表現にする (符号付きなら最上位ビットを反転する)
+    template <typename T>
+    constexpr std::make_unsigned_t<T> radix_key(T x) noexcept {
+        using U = std::make_unsigned_t<T>;
+        if constexpr (std::is_signed_v<T>) {
+            return U(x) ^ (U(1) << (std::numeric_limits<U>::digits - 1));
+        }
+        else {
+            return U(x);
+        }
+    }
+
+    // O(n sizeof(T))
+    // LSD 基数ソート (11 ビットずつ, 全要素で同じ桁は飛ばす)
+    // key(a[i]) が整数のキー (符号付きでもよい), 安定
+    template <typename Item, typename Key>
+    void radix_sort(std::vector<Item> &a, Key key) {
+        using K = std::decay_t<std::invoke_result_t<Key, const Item &>>;
+        static_assert(std::is_integral_v<K> && !std::is_same_v<K, bool>);
+        using U = std::make_unsigned_t<K>;
+
+        constexpr std::size_t bits = 11, buckets = std::size_t(1) << bits;
+        constexpr std::size_t passes = (std::numeric_limits<U>::digits + bits - 1) / bits;
+
+        auto n = a.size();
+        if (n <= 1) {
+            return;
+        }
+
+        // 全ての桁のヒストグラムを 1 回の走査で作る
+        std::vector<std::size_t> count(passes * buckets, 0);
+        for (auto &x : a) {
+            U k = radix_key(K(key(x)));
+            for (std::size_t p = 0; p < passes; ++p) {
+                ++count[p * buckets + ((k >> (p * bits)) & (buckets - 1))];
+            }
+        }
+
+        std::vector<Item> buf(n);
+        for (std::size_t p = 0; p < passes; ++p) {
+            auto c = count.data() + p * buckets;
+            if (*std::max_element(c, c + buckets) == n) {
+                continue;
+            }
+
+            std::size_t sum = 0;
+            for (std::size_t b = 0; b < buckets; ++b) {
+                auto t = c[b];
+                c[b] = sum;
+                sum += t;
+            }
+
+            for (auto &x : a) {
+                U k = radix_key(K(key(x)));
+                buf[c[(k >> (p * bits)) & (buckets - 1)]++] = x;
+            }
+            a.swap(buf);
+        }
+    }
+
+    // O(n sizeof(T))
+    // 整数の列を昇順に並べる
+    template <typename T>
+    void radix_sort(std::vector<T> &a) {
+        static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>);
+
+        radix_sort(a, [](T x) {
+            return x;
+        });
+    }
+
+    // 整数の座標圧縮
+    // 構築は基数ソートで O(n sizeof(T)), 値から番号への変換は Eytzinger 配置の二分探索で O(log m)
+    template <typename T, typename Index = std::uint32_t>
+    struct coordinate_compression {
+        static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>);
+
+        using value_type = T;
+        using index_type = Index;
+
+        // O(1)
+        coordinate_compression():
+            values_(), ids_(), eytzinger_(1, node{ T(), 0 }) {
+        }
+
+        // O(size(keys) sizeof(T))
+        // keys[i] の番号は ids()[i]
+        explicit coordinate_compression(const std::vector<T> &keys):
+            ids_(keys.size()) {
+
+            assert(keys.size() <= std::size_t(std::numeric_limits<Index>::max()));
+
+            struct item {
+                T key;
+                Index i;
+            };
+
+            std::vector<item> a(keys.size());
+            for (std::size_t i = 0; i < keys.size(); ++i) {
+                a[i] = { keys[i], Index(i) };
+            }
+
+            radix_sort(a, [](const item &x) {
+                return x.key;
+            });
+
+            for (std::size_t j = 0; j < a.size(); ++j) {
+                if (j == 0 || a[j - 1].key != a[j].key) {
+                    values_.push_back(a[j].key);
+                }
+                ids_[a[j].i] = Index(values_.size() - 1);
+            }
+
+            build_eytzinger();
+        }
+
+    public:
+        // O(1)
+        // 相異なる値の個数
+        std::size_t size() const noexcept {
+            return values_.size();
+        }
+
+        // O(1)
+        // 昇順に並んだ相異なる値
+        const std::vector<T> &values() const noexcept {
+            return values_;
+        }
+
+        // O(1)
+        // 構築に使った列の各要素の番号
+        const std::vector<Index> &ids() const noexcept {
+            return ids_;
+        }
+
+        // O(1)
+        T value(Index i) const {
+            assert(std::size_t(i) < size());
+
+            return values_[i];
+        }
+
+        // O(log size(coordinate_compression))
+        // x 以上の最小の値の番号 (x より小さい値の個数)
+        Index lower_bound(T x) const {
+            // 数段先の子孫が 1 つのキャッシュラインに収まるので, それを先読みしておく
+            constexpr std::size_t block = std::max<std::size_t>(64 / sizeof(node), 1);
+
+            std::size_t k = 1, m = values_.size();
+            while (k <= m) {
+                __builtin_prefetch(eytzinger_.data() + std::min(block * k, m));
+                k = 2 * k + (eytzinger_[k].key < x);
+            }
+            // 最後に左へ進んだ節点へ戻る
+            k >>= __builtin_ctzll(~k) + 1;
+
+            return eytzinger_[k].rank;
+        }
+
+        // O(log size(coordinate_compression))
+        // x の番号, 存在しなければ size(coordinate_compression)
+        Index find(T x) const {
+            auto i = lower_bound(x);
+            if (std::size_t(i) == size() || values_[i] != x) {
+                return Index(size());
+            }
+            return i;
+        }
+
+    private:
+        // eytzinger_[k] (1 <= k <= m) は根を 1, k の子を 2k, 2k + 1 とする完全二分木に中間順で値とその番号を置いたもの
+        // eytzinger_[0] は番号 m の番兵
+        void build_eytzinger() {
+            auto m = values_.size();
+            eytzinger_.assign(m + 1, node{ T(), Index(m) });
+
+            std::size_t j = 0, k = 1;
+            while (j < m) {
+                while (2 * k <= m) {
+                    k = 2 * k;
+                }
+                // 左端まで降りたので, ここから中間順に辿る
+                eytzinger_[k] = { values_[j], Index(j) }; ++j;
+
+                while (j < m) {
+                    if (2 * k + 1 <= m) {
+                        k = 2 * k + 1;
+                        break;
+                    }
+                    // 右の子がなければ, 左の子として登ってきた祖先まで戻る
+                    while (k & 1) {
+                        k >>= 1;
+                    }
+                    k >>= 1;
+                    eytzinger_[k] = { values_[j], Index(j) }; ++j;
+                }
+            }
+        }
+
+    private:
+        // 探索で見る値と, 見つかったときに返す番号を同じキャッシュラインに置く
+        struct node {
+            T key;
+            Index rank;
+        };
+
+        std::vector<T> values_;
+        std::vector<Index> ids_;
+
+        std::vector<node> eytzinger_;
+    };
+}
+
+#endif // STCP_COMPRESS_HPP
@@ -0,0 +1,179 @@
+#ifndef STCP_DENSE_SEGMENT_SET_HPP
+#define STCP_DENSE_SEGMENT_SET_HPP
+
+#include <utility>
+#include <optional>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include "stcp/fast_set.hpp"
+
+namespace stcp {
+    // [0, N) に収まる互いに重ならない区間の集合を管理する (segment_set と同じ操作を持つ)
+    // 覆われていない点と区間の左端をそれぞれ fast_set で持つ
+    template <std::size_t N>
+    struct dense_segment_set {
+        using int_type = std::size_t;
+
+        // O(N / 64)
+        dense_segment_set():
+            free_(N), head_(N) {
+            free_.set(0, N);
+        }
+
+    public:
+        // O((r - l) / 64 + log_64 N)
+        // 区間 [l, r) を追加する
+        // 既存要素と重なる部分はマージする (境界の接合は行わない)
+        void insert(int_type l, int_type r) {
+            assert(l <= r && r <= N);
+
+            if (l == r) {
+                return;
+            }
+
+            if (is_wrapped(l)) {
+                l = head_.prev(l);
+            }
+            if (is_wrapped(r - 1)) {
+                r = end_of(r - 1);
+            }
+
+            fill(l, r);
+        }
+
+        // O((r - l) / 64 + log_64 N)
+        // 区間 [l, r) を追加する
+        // clear(l, r) -> insert(l, r)
+        void overwrite(int_type l, int_type r) {
+            assert(l <= r && r <= N);
+
+            if (l == r) {
+                return;
+            }
+
+            clear(l, r);
+
+            fill(l, r);
+        }
+
+        // O(log_64 N)
+        // 要素 [x, k), [k, y) を [x, y) へマージする
+        void connect(int_type k) {
+            if (k == 0 || N <= k) {
+                return;
+            }
+
+            if (head_.test(k) && is_wrapped(k - 1)) {
+                head_.reset(k);
+            }
+        }
+
+        // O(log_64 N)
+        // 要素 [x, y) を [x, k), [k, y) に分割
+        void split(int_type k) {
+            if (is_wrapped(k)) {
+                head_.set(k);
+            }
+        }
+
+        // O((r - l) / 64 + log_64 N)
+        // 集合から [l, r) に重なる部分を *切り取り* 削除する
+        void clear(int_type l, int_type r) {
+            assert(l <= r && r <= N);
+
+            split(l);
+            split(r);
+
+            erase(l, r);
+        }
+
+        // O((r - l) / 64 + log_64 N)
+        // [l, r) に重なる区間を集合からすべて取り除く
+        void remove_covered(int_type l, int_type r) {
+            assert(l <= r && r <= N);
+
+            if (l == r) {
+                if (is_wrapped(l) && !head_.test(l)) {
+                    erase(head_.prev(l), end_of(l));
+                }
+                return;
+            }
+
+            if (is_wrapped(l)) {
+                l = head_.prev(l);
+            }
+            if (is_wrapped(r - 1)) {
+                r = end_of(r - 1);
+            }
+
+            erase(l, r);
+        }
+
+        // O(log_64 N)
+        // 存在するのなら l <= k < r な区間 [l, r) を返す
+        std::optional<std::pair<int_type, int_type>> wrapped(int_type k) const {
+            if (!is_wrapped(k)) {
+                return std::nullopt;
+            }
+
+            return std::make_pair(head_.prev(k), end_of(k));
+        }
+
+        // O(log_64 N)
+        // k を含む区間のサイズを取得する
+        std::size_t wrapped_size(int_type k) const {
+            auto _ = wrapped(k);
+
+            if (!_.has_value()) {
+                return 0;
+            }
+
+            auto [l, r] = *_;
+
+            return r - l;
+        }
+
+        // O(1)
+        // k を含む区間が存在するか
+        bool is_wrapped(int_type k) const {
+            return k < N && !free_.test(k);
+        }
+
+        // O(log_64 N)
+        // x, y が同じ区間に属するか
+        bool same(int_type x, int_type y) const {
+            auto _ = wrapped(x);
+
+            if (!_.has_value()) {
+                return false;
+            }
+
+            auto [l, r] = *_;
+
+            return l <= y && y < r;
+        }
+
+    private:
+        // k を含む区間の右端
+        int_type end_of(int_type k) const {
+            return std::min(free_.next(k + 1), head_.next(k + 1));
+        }
+
+        void fill(int_type l, int_type r) {
+            free_.reset(l, r);
+            head_.reset(l, r);
+            head_.set(l);
+        }
+
+        void erase(int_type l, int_type r) {
+            free_.set(l, r);
+            head_.reset(l, r);
+        }
+
+    private:
+        fast_set free_, head_;
+    };
+}
+
+#endif // STCP_DENSE_SEGMENT_SET_HPP
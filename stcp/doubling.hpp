@@ -2,34 +2,82 @@
 #define STCP_DOUBLING_HPP
 
 #include <vector>
+#include <thread>
 #include <type_traits>
 #include "stcp/base.hpp"
 
 namespace stcp {
+    // lazy ならば x^(2^i) は parse / operator [] で初めて必要になった時に計算する
+    // (表を伸ばすのは非 const のメンバ関数だけなので, 同じ doubling を複数のスレッドから使うなら lazy にしない)
+    // threads は範囲版の Op で 1 回の積を分けるスレッドの数
+    // window = w > 1 ならば repeat は n - 1 を 2^w 進で見て, 桁ごとに 2^w - 1 個の冪を表に持つ
+    // (表は必要になった桁から作る. 積の回数は 2 進の立っているビット数から 0 でない桁数に減る)
+    struct doubling_options {
+        bool lazy = false;
+        size_t threads = 1;
+        size_t window = 1;
+    };
+
     template <typename Int, typename T, typename Op>
     struct doubling {
         using int_type = Int;
 
+        // void Op(T &dst, const T &a, const T &b)
+        //     dst に a * b を書き込む (dst は a と同じ大きさで渡される)
+        // void Op(T &dst, const T &a, const T &b, size_t first, size_t last)
+        //     dst[first, last) だけを書き込む, 区間を分けて threads 個のスレッドから呼ばれる
+        constexpr static bool in_place =
+            std::is_invocable_v<Op &, T &, const T &, const T &>;
+        constexpr static bool ranged =
+            std::is_invocable_v<Op &, T &, const T &, const T &, size_t, size_t>;
+
         static_assert(
-            std::is_invocable_r_v<T, Op, const T, const T>,
+            std::is_invocable_r_v<T, Op, const T, const T> || in_place || ranged,
             "stcp::doubling Cannot call with 'T Op(T, T)'"
         );
 
-        doubling(size_t log2, T x, Op op):
-            log2_(log2), dub_(), op_(std::move(op)) {
+        // 通常は make_doubling, make_lazy_doubling, make_parallel_doubling から作る
+        doubling(size_t log2, T x, Op op, const doubling_options &options = doubling_options()):
+            log2_(log2), threads_(std::max<size_t>(options.threads, 1)), window_(options.window), dub_(), win_(), op_(std::move(op)) {
+
+            assert(1 <= window_ && window_ < 16);
 
-            dub_.push_back(x);
-            for (size_t i = 0; i < log2; ++i) {
-                x = op_(x, x);
-                dub_.push_back(x);
+            // 段を足しても再確保しないので, 返した参照は無効にならない
+            dub_.reserve(log2 + 1);
+            win_.reserve(log2 / window_ + 1);
+
+            dub_.push_back(std::move(x));
+            if (!options.lazy) {
+                compute(log2);
             }
         }
 
+        // 複製も全ての段の分を確保し直し, 以降の計算で再確保しないようにする
+        doubling(const doubling &other):
+            log2_(other.log2_), threads_(other.threads_), window_(other.window_), dub_(), win_(), op_(other.op_) {
+
+            dub_.reserve(log2_ + 1);
+            win_.reserve(log2_ / window_ + 1);
+
+            dub_.insert(std::end(dub_), std::begin(other.dub_), std::end(other.dub_));
+            win_.insert(std::end(win_), std::begin(other.win_), std::end(other.win_));
+        }
+        doubling(doubling &&) = default;
+
+        doubling &operator =(const doubling &) = delete;
+        doubling &operator =(doubling &&) = delete;
+
         // 0 <= a1 < a2 < ... < ak <= log2
         // 2^a1 + 2^a2 + ... + 2^ak = x
         // f(x^(2^a1)), f(x^(2^a2)), ..., f(x^(2^ak))
         template <typename F>
         void parse(int_type x, F f) {
+            size_t h = 0;
+            for (auto y = x; 1 < y; y >>= 1) {
+                ++h;
+            }
+            compute(h);
+
             auto iter = std::cbegin(dub_);
 
             while (0 < x) {
@@ -46,20 +94,37 @@ namespace stcp {
             assert(0 < n);
 
             auto acc = dub_[0];
-            parse(n - 1, [&](auto &f) {
-                acc = op_(acc, f);
-            });
+
+            if constexpr (in_place || ranged) {
+                auto tmp = acc;
+                parse_window(n - 1, [&](auto &f) {
+                    mul(tmp, acc, f);
+                    std::swap(acc, tmp);
+                });
+            }
+            else {
+                parse_window(n - 1, [&](auto &f) {
+                    acc = op_(acc, f);
+                });
+            }
 
             return acc;
         }
 
+        // apply(f, t) が値を返すならば t = apply(f, t)
+        // void ならば apply が t を直接書き換えるものとし, 状態の複製を行わない
         template <typename Apply>
         auto connect(Apply &&apply) {
             return [this, apply = std::forward<Apply>(apply)](int_type x, auto ...args) {
-                auto t = make_tuple(args...);
+                auto t = make_tuple(std::move(args)...);
 
                 parse(x, [&](auto &f) {
-                    t = apply(f, t);
+                    if constexpr (std::is_void_v<decltype(apply(f, t))>) {
+                        apply(f, t);
+                    }
+                    else {
+                        t = apply(f, t);
+                    }
                 });
 
                 return t;
@@ -70,19 +135,137 @@ namespace stcp {
             return log2_;
         }
 
+        size_t window() const noexcept {
+            return window_;
+        }
+
+        // 計算済みの x^(2^i) の最大の i
+        size_t max_computed_level() const noexcept {
+            return dub_.size() - 1;
+        }
+
+        // 返した参照は以降の計算で無効にならない
+        const T &operator [](size_t i) {
+            compute(i);
+
+            return dub_[i];
+        }
+
+        // 0 <= i <= max_computed_level()
         const T &operator [](size_t i) const {
+            assert(i < dub_.size());
+
             return dub_[i];
         }
 
     private:
-        const size_t log2_;
+        // x の 2^w 進の各桁 d (!= 0) について f(x^(d 2^(w j))) (w = window)
+        template <typename F>
+        void parse_window(int_type x, F f) {
+            if (window_ == 1) {
+                parse(x, f);
+                return;
+            }
+
+            auto mask = (int_type(1) << window_) - 1;
+            for (size_t j = 0; 0 < x; ++j, x >>= window_) {
+                if (auto d = size_t(x & mask); d != 0) {
+                    f(window_row(j)[d - 1]);
+                }
+            }
+        }
+
+        // x^(2^(w j)), x^(2 2^(w j)), ..., x^((2^w - 1) 2^(w j))
+        const std::vector<T> &window_row(size_t j) {
+            while (win_.size() <= j) {
+                auto i = win_.size() * window_;
+                compute(i);
+
+                auto &row = win_.emplace_back();
+                row.reserve((size_t(1) << window_) - 1);
+
+                row.push_back(dub_[i]);
+                for (size_t d = 2; d < (size_t(1) << window_); ++d) {
+                    row.push_back(product(row.back(), dub_[i]));
+                }
+            }
+
+            return win_[j];
+        }
+
+        // x^(2^0), ..., x^(2^i) を計算済みにする
+        void compute(size_t i) {
+            assert(i <= log2_);
+
+            while (dub_.size() <= i) {
+                const auto &x = dub_.back();
+
+                // push_back より前に x を読み終える
+                auto y = product(x, x);
+                dub_.push_back(std::move(y));
+            }
+        }
+
+        T product(const T &a, const T &b) {
+            if constexpr (in_place || ranged) {
+                auto dst = a;
+                mul(dst, a, b);
+                return dst;
+            }
+            else {
+                return op_(a, b);
+            }
+        }
+
+        // dst = a * b
+        void mul(T &dst, const T &a, const T &b) {
+            if constexpr (ranged) {
+                auto n = std::size(dst);
+                auto k = std::min(threads_, std::max<size_t>(n, 1));
+
+                std::vector<std::thread> th;
+                for (size_t t = 1; t < k; ++t) {
+                    th.emplace_back([&, t] {
+                        op_(dst, a, b, n * t / k, n * (t + 1) / k);
+                    });
+                }
+                op_(dst, a, b, 0, n / k);
+
+                for (auto &e : th) {
+                    e.join();
+                }
+            }
+            else {
+                op_(dst, a, b);
+            }
+        }
+
+    private:
+        const size_t log2_, threads_, window_;
         std::vector<T> dub_;
+        std::vector<std::vector<T>> win_;
         Op op_;
     };
 
     template <typename Int, typename T, typename Op>
-    auto make_doubling(size_t log2, T x, Op op) {
-        return doubling<Int, T, Op>(log2, std::move(x), std::move(op));
+    auto make_doubling(size_t log2, T x, Op op, size_t window = 1) {
+        doubling_options options;
+        options.window = window;
+        return doubling<Int, T, Op>(log2, std::move(x), std::move(op), options);
+    }
+
+    template <typename Int, typename T, typename Op>
+    auto make_lazy_doubling(size_t log2, T x, Op op) {
+        doubling_options options;
+        options.lazy = true;
+        return doubling<Int, T, Op>(log2, std::move(x), std::move(op), options);
+    }
+
+    template <typename Int, typename T, typename Op>
+    auto make_parallel_doubling(size_t log2, T x, Op op, size_t threads = std::thread::hardware_concurrency()) {
+        doubling_options options;
+        options.threads = threads;
+        return doubling<Int, T, Op>(log2, std::move(x), std::move(op), options);
     }
 }
 
@@ -1,15 +1,22 @@
 #ifndef STCP_DUAL_SEGMENT_TREE_HPP
 #define STCP_DUAL_SEGMENT_TREE_HPP
 
+#include <type_traits>
 #include <utility>
 #include <vector>
+#include <memory>
 #include <cassert>
 #include <cstddef>
+#include "stcp/monoid.hpp"
 
 namespace stcp {
-    template <typename S, typename F, S (*Mapping)(F, S), F (*Composition)(F, F), F (*Id)()>
+    // 要素と遅延作用の列は Allocator (を rebind したもの) で確保する
+    // Commutative (Composition が可換) ならば, 作用は節点に置いたまま下ろさない
+    // monoid.hpp の作用からは dual_segment_tree_of で作ると, 作用の commutative から決まる
+    template <typename S, typename F, S (*Mapping)(F, S), F (*Composition)(F, F), F (*Id)(), bool Commutative = false, typename Allocator = std::allocator<S>>
     struct dual_segment_tree {
         using value_type = S;
+        using allocator_type = Allocator;
 
         // O(1)
         dual_segment_tree():
@@ -17,36 +24,41 @@ namespace stcp {
         }
 
         // O(n)
-        explicit dual_segment_tree(std::size_t n):
-            n_(n) {
+        explicit dual_segment_tree(std::size_t n, const Allocator &alloc = Allocator()):
+            data_(alloc), lazy_(alloc), n_(n) {
             log_ = 0;
             while ((std::size_t(1) << log_) < n_) {
                 ++log_;
             }
             size_ = (1 << log_);
 
-            data_ = std::vector<S>(n_);
-            lazy_ = std::vector<F>(size_, Id());
+            data_.resize(n_);
+            lazy_.assign(size_, Id());
         }
 
         // O(size(v))
-        explicit dual_segment_tree(std::vector<S> v):
-            n_(v.size()) {
+        explicit dual_segment_tree(std::vector<S> v, const Allocator &alloc = Allocator()):
+            data_(alloc), lazy_(alloc), n_(v.size()) {
             log_ = 0;
             while ((std::size_t(1) << log_) < n_) {
                 ++log_;
             }
             size_ = (1 << log_);
 
-            data_ = std::move(v);
-            lazy_ = std::vector<F>(size_, Id());
+            if constexpr (std::is_same_v<decltype(data_), std::vector<S>>) {
+                data_ = std::move(v);
+            }
+            else {
+                data_.assign(v.begin(), v.end());
+            }
+            lazy_.assign(size_, Id());
         }
 
     public:
         // O(log size(dual_segment_tree))
         // 0 <= i < size(dual_segment_tree)
         void set(std::size_t i, S x) {
-            assert(0 <= i && i < n_);
+            assert(i < n_);
 
             i += size_;
             for (auto j = log_; 1 <= j; --j) {
@@ -59,32 +71,44 @@ namespace stcp {
         // O(log size(dual_segment_tree))
         // 0 <= i < size(dual_segment_tree)
         S get(std::size_t i) const {
-            assert(0 <= i && i < n_);
+            assert(i < n_);
 
             i += size_;
-            for (auto j = log_; 1 <= j; --j) {
-                apply_lazy(i >> j);
-            }
 
-            return data_[i - size_];
+            if constexpr (permanent) {
+                F f = Id();
+                for (auto j = log_; 1 <= j; --j) {
+                    f = Composition(f, lazy_[i >> j]);
+                }
+                return Mapping(f, data_[i - size_]);
+            }
+            else {
+                for (auto j = log_; 1 <= j; --j) {
+                    apply_lazy(i >> j);
+                }
+                return data_[i - size_];
+            }
         }
 
         // O(log size(dual_segment_tree))
         // 0 <= l <= r <= size(dual_segment_tree)
         void apply(std::size_t l, std::size_t r, F f) {
-            assert(0 <= l && l <= r && r <= n_);
+            assert(l <= r && r <= n_);
 
             if (l == r) {
                 return;
             }
             l += size_; r += size_;
 
-            for (auto i = log_; 1 <= i; --i) {
-                if (((l >> i) << i) != l) {
-                    apply_lazy(l >> i);
-                }
-                if (((r >> i) << i) != r) {
-                    apply_lazy((r - 1) >> i);
+            // 作用の順序が結果に影響しなければ, 先に境界の作用を下ろす必要はない
+            if constexpr (!permanent) {
+                for (auto i = log_; 1 <= i; --i) {
+                    if (((l >> i) << i) != l) {
+                        apply_lazy(l >> i);
+                    }
+                    if (((r >> i) << i) != r) {
+                        apply_lazy((r - 1) >> i);
+                    }
                 }
             }
 
@@ -100,6 +124,8 @@ namespace stcp {
         }
 
     private:
+        static constexpr bool permanent = Commutative;
+
         void apply_lazy(std::size_t i) const {
             push_lazy(i + i, lazy_[i]);
             push_lazy(i + i + 1, lazy_[i]);
@@ -115,10 +141,15 @@ namespace stcp {
         }
 
     private:
-        mutable std::vector<S> data_;
-        mutable std::vector<F> lazy_;
+        mutable std::vector<S, Allocator> data_;
+        mutable std::vector<F, typename std::allocator_traits<Allocator>::template rebind_alloc<F>> lazy_;
         std::size_t n_, size_, log_;
     };
+
+    // 作用 A (add_action など) の mapping, composition, id を使う dual_segment_tree
+    template <typename A, typename Allocator = std::allocator<typename A::value_type>>
+    using dual_segment_tree_of = dual_segment_tree<
+        typename A::value_type, typename A::action_type, A::mapping, A::composition, A::id, is_commutative_v<A>, Allocator>;
 }
 
 #endif // STCP_DUAL_SEGMENT_TREE_HPP
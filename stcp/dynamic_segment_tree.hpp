@@ -3,13 +3,20 @@
 
 #include <type_traits>
 #include <utility>
+#include <memory>
 #include <cassert>
 #include <cstddef>
+#include "stcp/arena.hpp"
+#include "stcp/stats.hpp"
 
 namespace stcp {
-    template <typename S, S (*Op)(S, S), S (*E)()>
-    struct dynamic_segment_tree {
+    // 節点は Allocator (を節点型に rebind したもの) で確保する
+    // arena_allocator を渡すと確保はポインタを進めるだけになり, 破棄は節点をたどらない
+    // STCP_ENABLE_STATS のとき stats() で Op の呼び出し・節点の訪問・確保の回数を返す
+    template <typename S, S (*Op)(S, S), S (*E)(), typename Allocator = std::allocator<S>>
+    struct dynamic_segment_tree: stats_recorder<dynamic_segment_tree<S, Op, E, Allocator>> {
         using value_type = S;
+        using allocator_type = Allocator;
 
         // O(1)
         dynamic_segment_tree() noexcept:
@@ -17,19 +24,48 @@ namespace stcp {
         }
 
         // O(1)
-        dynamic_segment_tree(std::size_t n) noexcept:
-            n_(n), root_(nullptr) {
+        dynamic_segment_tree(std::size_t n, const Allocator &alloc = Allocator()) noexcept:
+            n_(n), root_(nullptr), alloc_(alloc) {
+        }
+
+        // O(other の節点数)
+        dynamic_segment_tree(const dynamic_segment_tree &other):
+            n_(other.n_), root_(nullptr),
+            alloc_(node_traits::select_on_container_copy_construction(other.alloc_)) {
+            root_ = copy_tree(other.root_);
+        }
+
+        // O(1)
+        dynamic_segment_tree(dynamic_segment_tree &&other) noexcept:
+            n_(other.n_), root_(std::exchange(other.root_, nullptr)), alloc_(other.alloc_) {
+        }
+
+        dynamic_segment_tree &operator =(dynamic_segment_tree other) noexcept {
+            std::swap(n_, other.n_);
+            std::swap(root_, other.root_);
+            std::swap(alloc_, other.alloc_);
+            return *this;
         }
 
         ~dynamic_segment_tree() {
-            if (root_ != nullptr) delete root_;
+            release();
         }
 
     public:
+        // O(節点数) (arena_allocator かつ S が自明に破棄できるなら O(1))
+        // 全ての要素を E() に戻す
+        void clear() {
+            release();
+        }
+
+        allocator_type get_allocator() const noexcept {
+            return allocator_type(alloc_);
+        }
+
         // O(log size(dynamic_segment_tree))
         // 0 <= i < size(dynamic_segment_tree)
         void set(std::size_t i, S x) {
-            assert(0 <= i && i < n_);
+            assert(i < n_);
 
             update_tree(root_, 0, n_, i, x);
         }
@@ -37,7 +73,7 @@ namespace stcp {
         // O(log size(dynamic_segment_tree))
         // 0 <= i < size(dynamic_segment_tree)
         S get(std::size_t i) const {
-            assert(0 <= i && i < n_);
+            assert(i < n_);
 
             return get(root_, 0, n_, i);
         }
@@ -50,7 +86,7 @@ namespace stcp {
         // O(log size(dynamic_segment_tree))
         // 0 <= l <= r <= size(dynamic_segment_tree)
         S prod(std::size_t l, std::size_t r) const {
-            assert(0 <= l && l <= r && r <= n_);
+            assert(l <= r && r <= n_);
 
             return prod(root_, 0, n_, l, r);
         }
@@ -69,7 +105,7 @@ namespace stcp {
         std::size_t max_right(std::size_t l, F &&f) const {
             static_assert(std::is_invocable_r_v<bool, F, S>);
 
-            assert(0 <= l && l <= n_);
+            assert(l <= n_);
             assert(std::forward<F>(f)(E()));
 
             S acc = E();
@@ -84,7 +120,7 @@ namespace stcp {
         std::size_t min_left(std::size_t r, F &&f) const {
             static_assert(std::is_invocable_r_v<bool, F, S>);
 
-            assert(0 <= r && r <= n_);
+            assert(r <= n_);
             assert(std::forward<F>(f)(E()));
 
             S acc = E();
@@ -94,18 +130,20 @@ namespace stcp {
         }
 
     private:
+        using recorder = stats_recorder<dynamic_segment_tree>;
+
+        static S op(S x, S y) {
+            recorder::count_op();
+            return Op(x, y);
+        }
+
         struct node {
             node(std::size_t i, S value):
                 i(i), value(value), prod(value), l(nullptr), r(nullptr) {
             }
 
-            ~node() {
-                if (l != nullptr) delete l;
-                if (r != nullptr) delete r;
-            }
-
             void update() {
-                prod = Op(Op(
+                prod = op(op(
                     l != nullptr ? l->prod : E(),
                     value),
                     r != nullptr ? r->prod : E()
@@ -117,13 +155,56 @@ namespace stcp {
             node *l, *r;
         };
 
-        static void update_tree(node* &range, std::size_t l, std::size_t r, std::size_t i, S x) {
+        using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<node>;
+        using node_traits = std::allocator_traits<node_allocator>;
+
+        node *create_node(std::size_t i, S x) {
+            recorder::count_allocation();
+            auto range = node_traits::allocate(alloc_, 1);
+            node_traits::construct(alloc_, range, i, x);
+            return range;
+        }
+
+        void destroy_tree(node *range) {
+            if (range == nullptr) {
+                return;
+            }
+
+            destroy_tree(range->l);
+            destroy_tree(range->r);
+
+            node_traits::destroy(alloc_, range);
+            node_traits::deallocate(alloc_, range, 1);
+        }
+
+        void release() {
+            if constexpr (!(is_monotonic_allocator_v<Allocator> && std::is_trivially_destructible_v<S>)) {
+                destroy_tree(root_);
+            }
+            root_ = nullptr;
+        }
+
+        node *copy_tree(const node *range) {
+            if (range == nullptr) {
+                return nullptr;
+            }
+
+            auto copy = create_node(range->i, range->value);
+            copy->prod = range->prod;
+            copy->l = copy_tree(range->l);
+            copy->r = copy_tree(range->r);
+
+            return copy;
+        }
+
+        void update_tree(node* &range, std::size_t l, std::size_t r, std::size_t i, S x) {
             using std::swap;
 
             if (range == nullptr) {
-                range = new node(i, x);
+                range = create_node(i, x);
                 return;
             }
+            recorder::count_visit();
 
             if (range->i == i) {
                 range->value = x;
@@ -154,6 +235,7 @@ namespace stcp {
             if (range == nullptr) {
                 return E();
             }
+            recorder::count_visit();
 
             if (range->i == i) {
                 return range->value;
@@ -170,6 +252,7 @@ namespace stcp {
             if (range == nullptr || r <= query_l || query_r <= l) {
                 return E();
             }
+            recorder::count_visit();
 
             if (query_l <= l && r <= query_r) {
                 return range->prod;
@@ -179,9 +262,9 @@ namespace stcp {
 
             S acc = prod(range->l, l, m, query_l, query_r);
             if (query_l <= range->i && range->i < query_r) {
-                acc = Op(acc, range->value);
+                acc = op(acc, range->value);
             }
-            return Op(acc, prod(range->r, m, r, query_l, query_r));
+            return op(acc, prod(range->r, m, r, query_l, query_r));
         }
 
         template <typename F>
@@ -189,6 +272,7 @@ namespace stcp {
             if (range == nullptr || r <= query_l) {
                 return r;
             }
+            recorder::count_visit();
 
             auto m = l + (r - l) / 2;
 
@@ -198,7 +282,7 @@ namespace stcp {
             }
 
             if (query_l <= range->i) {
-                if (S con = Op(acc, range->value); f(con)) {
+                if (S con = op(acc, range->value); f(con)) {
                     acc = con;
                 }
                 else {
@@ -211,7 +295,7 @@ namespace stcp {
                     return r;
                 }
 
-                if (S con = Op(acc, range->r->prod); f(con)) {
+                if (S con = op(acc, range->r->prod); f(con)) {
                     acc = con;
                     return r;
                 }
@@ -225,6 +309,7 @@ namespace stcp {
             if (range == nullptr || query_r <= l) {
                 return l;
             }
+            recorder::count_visit();
 
             auto m = l + (r - l) / 2;
 
@@ -234,7 +319,7 @@ namespace stcp {
             }
 
             if (range->i < query_r) {
-                if (S con = Op(range->value, acc); f(con)) {
+                if (S con = op(range->value, acc); f(con)) {
                     acc = con;
                 }
                 else {
@@ -247,7 +332,7 @@ namespace stcp {
                     return l;
                 }
 
-                if (S con = Op(range->l->prod, acc); f(con)) {
+                if (S con = op(range->l->prod, acc); f(con)) {
                     acc = con;
                     return l;
                 }
@@ -259,6 +344,7 @@ namespace stcp {
     private:
         std::size_t n_;
         node *root_;
+        node_allocator alloc_;
     };
 }
 
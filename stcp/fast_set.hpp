@@ -0,0 +1,220 @@
+#ifndef STCP_FAST_SET_HPP
+#define STCP_FAST_SET_HPP
+
+#include <algorithm>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace stcp {
+    // [0, n) の部分集合を 64 分木のビット列で管理する
+    // 上の段の各ビットは直下の段の対応するワードが 0 でないかを表す
+    struct fast_set {
+        // O(1)
+        fast_set():
+            fast_set(0) {
+        }
+
+        // O(n / 64)
+        explicit fast_set(std::size_t n):
+            n_(n) {
+            do {
+                n = (n + 63) >> 6;
+                seg_.emplace_back(std::max<std::size_t>(n, 1), 0);
+            } while (1 < n);
+        }
+
+    public:
+        // O(1)
+        std::size_t size() const noexcept {
+            return n_;
+        }
+
+        // O(1)
+        // 0 <= k < size(fast_set)
+        bool test(std::size_t k) const noexcept {
+            assert(k < n_);
+
+            return (seg_[0][k >> 6] >> (k & 63)) & 1;
+        }
+
+        // O(log_64 size(fast_set))
+        // 0 <= k < size(fast_set)
+        void set(std::size_t k) noexcept {
+            assert(k < n_);
+
+            set_bit(0, k);
+        }
+
+        // O(log_64 size(fast_set))
+        // 0 <= k < size(fast_set)
+        void reset(std::size_t k) noexcept {
+            assert(k < n_);
+
+            reset_bit(0, k);
+        }
+
+        // O((r - l) / 64 + log_64 size(fast_set))
+        // 0 <= l <= r <= size(fast_set)
+        void set(std::size_t l, std::size_t r) noexcept {
+            assert(l <= r && r <= n_);
+
+            set_range(0, l, r);
+        }
+
+        // O((r - l) / 64 + log_64 size(fast_set))
+        // 0 <= l <= r <= size(fast_set)
+        void reset(std::size_t l, std::size_t r) noexcept {
+            assert(l <= r && r <= n_);
+
+            reset_range(0, l, r);
+        }
+
+        // O(log_64 size(fast_set))
+        // k 以上の最小の要素, 存在しなければ size(fast_set)
+        std::size_t next(std::size_t k) const noexcept {
+            for (std::size_t h = 0; h < seg_.size(); ++h) {
+                auto w = k >> 6;
+                if (seg_[h].size() <= w) {
+                    break;
+                }
+
+                auto x = seg_[h][w] >> (k & 63);
+                if (x == 0) {
+                    k = w + 1;
+                    continue;
+                }
+
+                k += __builtin_ctzll(x);
+                for (auto g = h; 0 < g--; ) {
+                    k = (k << 6) + __builtin_ctzll(seg_[g][k]);
+                }
+                return k;
+            }
+
+            return n_;
+        }
+
+        // O(log_64 size(fast_set))
+        // k 以下の最大の要素, 存在しなければ size(fast_set)
+        std::size_t prev(std::size_t k) const noexcept {
+            if (n_ == 0) {
+                return n_;
+            }
+            k = std::min(k, n_ - 1);
+
+            for (std::size_t h = 0; h < seg_.size(); ++h) {
+                auto w = k >> 6;
+
+                auto x = seg_[h][w] << (63 - (k & 63));
+                if (x == 0) {
+                    if (w == 0) {
+                        break;
+                    }
+                    k = w - 1;
+                    continue;
+                }
+
+                k -= __builtin_clzll(x);
+                for (auto g = h; 0 < g--; ) {
+                    k = (k << 6) + 63 - __builtin_clzll(seg_[g][k]);
+                }
+                return k;
+            }
+
+            return n_;
+        }
+
+    private:
+        // [l, r) (0 <= l < r <= 64) のビットが立ったマスク
+        static std::uint64_t mask(std::size_t l, std::size_t r) noexcept {
+            auto x = ~std::uint64_t(0) << l;
+            if (r < 64) {
+                x &= (std::uint64_t(1) << r) - 1;
+            }
+            return x;
+        }
+
+        void set_bit(std::size_t h, std::size_t k) noexcept {
+            for (; h < seg_.size(); ++h) {
+                auto &w = seg_[h][k >> 6];
+                auto was = w;
+
+                w |= std::uint64_t(1) << (k & 63);
+                if (was != 0) {
+                    break;
+                }
+                k >>= 6;
+            }
+        }
+
+        void reset_bit(std::size_t h, std::size_t k) noexcept {
+            for (; h < seg_.size(); ++h) {
+                auto &w = seg_[h][k >> 6];
+
+                w &= ~(std::uint64_t(1) << (k & 63));
+                if (w != 0) {
+                    break;
+                }
+                k >>= 6;
+            }
+        }
+
+        // 内側のワードはまとめて埋める (std::fill_n はベクトル化される)
+        void set_range(std::size_t h, std::size_t l, std::size_t r) noexcept {
+            if (h == seg_.size() || r <= l) {
+                return;
+            }
+
+            auto &s = seg_[h];
+            auto wl = l >> 6, wr = (r - 1) >> 6;
+
+            if (wl == wr) {
+                s[wl] |= mask(l & 63, ((r - 1) & 63) + 1);
+            }
+            else {
+                s[wl] |= mask(l & 63, 64);
+                std::fill_n(s.begin() + wl + 1, wr - wl - 1, ~std::uint64_t(0));
+                s[wr] |= mask(0, ((r - 1) & 63) + 1);
+            }
+
+            set_range(h + 1, wl, wr + 1);
+        }
+
+        void reset_range(std::size_t h, std::size_t l, std::size_t r) noexcept {
+            if (h == seg_.size() || r <= l) {
+                return;
+            }
+
+            auto &s = seg_[h];
+            auto wl = l >> 6, wr = (r - 1) >> 6;
+
+            if (wl == wr) {
+                s[wl] &= ~mask(l & 63, ((r - 1) & 63) + 1);
+            }
+            else {
+                s[wl] &= ~mask(l & 63, 64);
+                std::fill_n(s.begin() + wl + 1, wr - wl - 1, std::uint64_t(0));
+                s[wr] &= ~mask(0, ((r - 1) & 63) + 1);
+            }
+
+            if (h + 1 == seg_.size()) {
+                return;
+            }
+
+            reset_range(h + 1, wl + 1, wr);
+            for (auto w : { wl, wr }) {
+                if (s[w] == 0) {
+                    reset_bit(h + 1, w);
+                }
+            }
+        }
+
+    private:
+        std::size_t n_;
+        std::vector<std::vector<std::uint64_t>> seg_;
+    };
+}
+
+#endif // STCP_FAST_SET_HPP
@@ -0,0 +1,267 @@
+#ifndef STCP_FUNCTIONAL_GRAPH_CYCLE_HPP
+#define STCP_FUNCTIONAL_GRAPH_CYCLE_HPP
+
+#include <utility>
+#include <algorithm>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace stcp {
+    // 各頂点 v から辺 v -> next[v] (重み agg[v]) がちょうど 1 本出ているグラフを
+    // サイクルとそこへ流れ込む木に分解し, k 歩先の頂点と通った辺の集約を求める
+    // (S, Op, E, Inv) は群であること (位置だけが必要ならば自明な群でよい)
+    // functional_graph_doubling と違い k の大きさによらず O(n) のメモリで済む
+    template <typename Index, typename S, S (*Op)(S, S), S (*E)(), S (*Inv)(S)>
+    struct functional_graph_cycle {
+        using index_type = Index;
+        using value_type = S;
+
+        // O(n)
+        // 0 <= next[v] < n
+        functional_graph_cycle(const std::vector<Index> &next, const std::vector<S> &agg):
+            n_(next.size()), next_(next),
+            depth_(n_, 0), root_(n_), tin_(n_), tail_(n_, E()),
+            cycle_(n_), cycle_pos_(n_), cycle_id_(n_) {
+
+            assert(next.size() == agg.size());
+
+            build_cycles(agg);
+            build_tails(agg);
+        }
+
+    public:
+        // O(1)
+        std::size_t size() const noexcept {
+            return n_;
+        }
+
+        // O(1)
+        bool on_cycle(Index v) const {
+            assert(std::size_t(v) < n_);
+
+            return depth_[v] == 0;
+        }
+
+        // O(1)
+        // v からサイクルに入るまでの歩数
+        std::size_t depth(Index v) const {
+            assert(std::size_t(v) < n_);
+
+            return depth_[v];
+        }
+
+        // O(1)
+        // v から辿り着くサイクルの長さ
+        std::size_t cycle_length(Index v) const {
+            assert(std::size_t(v) < n_);
+
+            auto c = cycle_id_[root_[v]];
+            return cycle_offset_[c + 1] - cycle_offset_[c];
+        }
+
+        // サイクル上: O(1), 木の上: O(log n)
+        // v から k 歩進んだ頂点
+        Index next(Index v, std::uint64_t k) const {
+            assert(std::size_t(v) < n_);
+
+            if (k <= std::size_t(depth_[v])) {
+                return ancestor(v, k);
+            }
+            k -= depth_[v];
+
+            auto r = root_[v];
+            auto c = cycle_id_[r];
+            auto l = cycle_offset_[c + 1] - cycle_offset_[c];
+
+            return cycle_[cycle_offset_[c] + (cycle_pos_[r] + k % l) % l];
+        }
+
+        // O(log n + log (k / サイクル長))
+        // v から k 歩進んだ頂点と, 通った辺の集約
+        std::pair<Index, S> jump(Index v, std::uint64_t k) const {
+            assert(std::size_t(v) < n_);
+
+            if (k <= std::size_t(depth_[v])) {
+                auto u = ancestor(v, k);
+                return { u, Op(tail_[v], Inv(tail_[u])) };
+            }
+            k -= depth_[v];
+
+            auto r = root_[v];
+            auto c = cycle_id_[r];
+            auto l = cycle_offset_[c + 1] - cycle_offset_[c];
+            auto p = std::size_t(cycle_pos_[r]), rem = std::size_t(k % l);
+
+            S acc = tail_[v];
+            acc = Op(acc, pow(fold(c, p, p + l), k / l));
+            acc = Op(acc, fold(c, p, p + rem));
+
+            return { cycle_[cycle_offset_[c] + (p + rem) % l], acc };
+        }
+
+    private:
+        // サイクル c を 2 周並べたときの [i, j) 番目の辺の集約
+        S fold(std::size_t c, std::size_t i, std::size_t j) const {
+            auto base = 2 * cycle_offset_[c] + c;
+            return Op(Inv(prefix_[base + i]), prefix_[base + j]);
+        }
+
+        static S pow(S x, std::uint64_t k) {
+            S acc = E();
+            while (0 < k) {
+                if (k & 1) {
+                    acc = Op(acc, x);
+                }
+                x = Op(x, x); k >>= 1;
+            }
+            return acc;
+        }
+
+        // 木の上で v の k 個上の頂点 (k <= depth(v))
+        Index ancestor(Index v, std::uint64_t k) const {
+            if (k == 0) {
+                return v;
+            }
+
+            auto d = depth_[v] - k;
+            auto first = by_depth_.begin() + depth_offset_[d];
+            auto last = by_depth_.begin() + depth_offset_[d + 1];
+
+            auto iter = std::upper_bound(first, last, tin_[v], [&](Index t, Index u) {
+                return t < tin_[u];
+            });
+
+            return *std::prev(iter);
+        }
+
+        void build_cycles(const std::vector<S> &agg) {
+            std::vector<std::uint8_t> state(n_, 0);
+            std::vector<Index> path;
+
+            cycle_offset_.push_back(0);
+
+            for (std::size_t s = 0; s < n_; ++s) {
+                if (state[s] != 0) {
+                    continue;
+                }
+
+                auto v = Index(s);
+                while (state[v] == 0) {
+                    state[v] = 1; path.push_back(v);
+                    v = next_[v];
+                }
+
+                if (state[v] == 1) {
+                    auto c = cycle_offset_.size() - 1;
+                    auto base = cycle_offset_.back();
+                    cycle_offset_.push_back(base);
+
+                    auto u = v;
+                    do {
+                        cycle_pos_[u] = Index(cycle_offset_.back() - base);
+                        cycle_id_[u] = Index(c);
+                        cycle_[cycle_offset_.back()++] = u;
+                        u = next_[u];
+                    } while (u != v);
+
+                    auto l = cycle_offset_.back() - base;
+                    prefix_.push_back(E());
+                    for (std::size_t i = 0; i < 2 * l; ++i) {
+                        prefix_.push_back(Op(prefix_.back(), agg[cycle_[base + i % l]]));
+                    }
+                }
+
+                for (auto u : path) {
+                    state[u] = 2;
+                }
+                path.clear();
+            }
+        }
+
+        void build_tails(const std::vector<S> &agg) {
+            std::vector<std::size_t> offset(n_ + 1, 0);
+            for (std::size_t v = 0; v < n_; ++v) {
+                ++offset[next_[v] + 1];
+            }
+            for (std::size_t v = 0; v < n_; ++v) {
+                offset[v + 1] += offset[v];
+            }
+
+            std::vector<Index> child(n_);
+            {
+                auto pos = offset;
+                for (std::size_t v = 0; v < n_; ++v) {
+                    child[pos[next_[v]]++] = Index(v);
+                }
+            }
+
+            std::vector<std::uint8_t> cyclic(n_, 0);
+            for (std::size_t i = 0; i < cycle_offset_.back(); ++i) {
+                cyclic[cycle_[i]] = 1;
+            }
+
+            std::vector<Index> order, stack;
+            order.reserve(n_);
+
+            std::size_t max_depth = 0;
+            for (std::size_t i = 0; i < cycle_offset_.back(); ++i) {
+                auto r = cycle_[i];
+                root_[r] = r;
+
+                stack.push_back(r);
+                while (!stack.empty()) {
+                    auto v = stack.back(); stack.pop_back();
+
+                    tin_[v] = Index(order.size());
+                    order.push_back(v);
+                    max_depth = std::max<std::size_t>(max_depth, depth_[v]);
+
+                    for (auto j = offset[v]; j < offset[v + 1]; ++j) {
+                        auto u = child[j];
+                        if (cyclic[u]) {
+                            continue;
+                        }
+
+                        depth_[u] = depth_[v] + 1;
+                        root_[u] = r;
+                        tail_[u] = Op(agg[u], tail_[v]);
+                        stack.push_back(u);
+                    }
+                }
+            }
+
+            depth_offset_.assign(max_depth + 2, 0);
+            for (auto v : order) {
+                ++depth_offset_[depth_[v] + 1];
+            }
+            for (std::size_t d = 0; d <= max_depth; ++d) {
+                depth_offset_[d + 1] += depth_offset_[d];
+            }
+
+            by_depth_.resize(n_);
+            auto pos = depth_offset_;
+            for (auto v : order) {
+                by_depth_[pos[depth_[v]]++] = v;
+            }
+        }
+
+    private:
+        std::size_t n_;
+        std::vector<Index> next_;
+
+        // 木: サイクルまでの距離, 入るサイクルの頂点, 行きがけ順, サイクルまでの辺の集約
+        std::vector<Index> depth_, root_, tin_;
+        std::vector<S> tail_;
+        std::vector<std::size_t> depth_offset_;
+        std::vector<Index> by_depth_;
+
+        // サイクル: 頂点列, 頂点の位置と番号, 2 周分の累積
+        std::vector<Index> cycle_, cycle_pos_, cycle_id_;
+        std::vector<std::size_t> cycle_offset_;
+        std::vector<S> prefix_;
+    };
+}
+
+#endif // STCP_FUNCTIONAL_GRAPH_CYCLE_HPP
@@ -0,0 +1,121 @@
+#ifndef STCP_FUNCTIONAL_GRAPH_DOUBLING_HPP
+#define STCP_FUNCTIONAL_GRAPH_DOUBLING_HPP
+
+#include <utility>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace stcp {
+    // 各頂点 v から辺 v -> next[v] (重み agg[v]) がちょうど 1 本出ているグラフのダブリング
+    // 段 i の表は next_[i * n + v], agg_[i * n + v] に連続して置く
+    template <typename Index, typename S, S (*Op)(S, S), S (*E)()>
+    struct functional_graph_doubling {
+        using index_type = Index;
+        using value_type = S;
+
+        // O(n log2)
+        // 0 <= next[v] < n
+        functional_graph_doubling(std::size_t log2, const std::vector<Index> &next, const std::vector<S> &agg):
+            n_(next.size()), log2_(log2),
+            next_((log2 + 1) * next.size()), agg_((log2 + 1) * next.size()) {
+
+            assert(next.size() == agg.size());
+
+            for (std::size_t v = 0; v < n_; ++v) {
+                assert(std::size_t(next[v]) < n_);
+
+                next_[v] = next[v];
+                agg_[v] = agg[v];
+            }
+
+            for (std::size_t i = 1; i <= log2_; ++i) {
+                auto p = (i - 1) * n_, q = i * n_;
+
+                for (std::size_t v = 0; v < n_; ++v) {
+                    auto u = next_[p + v];
+
+                    next_[q + v] = next_[p + u];
+                    agg_[q + v] = Op(agg_[p + v], agg_[p + u]);
+                }
+            }
+        }
+
+    public:
+        // O(1)
+        std::size_t size() const noexcept {
+            return n_;
+        }
+
+        // O(1)
+        std::size_t log2() const noexcept {
+            return log2_;
+        }
+
+        // O(1)
+        // 2^i 歩先の頂点
+        Index next(std::size_t i, Index v) const {
+            assert(i <= log2_ && std::size_t(v) < n_);
+
+            return next_[i * n_ + v];
+        }
+
+        // O(1)
+        // 2^i 歩で通る辺の集約
+        S agg(std::size_t i, Index v) const {
+            assert(i <= log2_ && std::size_t(v) < n_);
+
+            return agg_[i * n_ + v];
+        }
+
+        // O(log k)
+        // 0 <= k < 2^(log2 + 1)
+        // v から k 歩進んだ頂点と, 通った辺の集約
+        std::pair<Index, S> jump(Index v, std::uint64_t k) const {
+            assert(std::size_t(v) < n_);
+            assert(log2_ + 1 >= 64 || (k >> (log2_ + 1)) == 0);
+
+            S acc = E();
+            for (std::size_t i = 0; 0 < k; ++i, k >>= 1) {
+                if (k & 1) {
+                    acc = Op(acc, agg_[i * n_ + v]);
+                    v = next_[i * n_ + v];
+                }
+            }
+
+            return { v, acc };
+        }
+
+        // O(size(v) log k)
+        // 0 <= k < 2^(log2 + 1)
+        // v の各頂点を一斉に k 歩進め, acc に通った辺の集約を書き込む
+        // 段ごとに全ての始点を処理するので, 各段の表は一度ずつ走査される
+        void jump_many(std::vector<Index> &v, std::vector<S> &acc, std::uint64_t k) const {
+            assert(log2_ + 1 >= 64 || (k >> (log2_ + 1)) == 0);
+
+            acc.assign(v.size(), E());
+
+            for (std::size_t i = 0; 0 < k; ++i, k >>= 1) {
+                if ((k & 1) == 0) {
+                    continue;
+                }
+
+                auto nx = next_.data() + i * n_;
+                auto ag = agg_.data() + i * n_;
+
+                for (std::size_t j = 0; j < v.size(); ++j) {
+                    acc[j] = Op(acc[j], ag[v[j]]);
+                    v[j] = nx[v[j]];
+                }
+            }
+        }
+
+    private:
+        std::size_t n_, log2_;
+        std::vector<Index> next_;
+        std::vector<S> agg_;
+    };
+}
+
+#endif // STCP_FUNCTIONAL_GRAPH_DOUBLING_HPP
@@ -0,0 +1,68 @@
+#ifndef STCP_HUGE_PAGE_ALLOCATOR_HPP
+#define STCP_HUGE_PAGE_ALLOCATOR_HPP
+
+#include <new>
+#include <cstddef>
+#include <cstdlib>
+
+#include <sys/mman.h>
+
+namespace stcp {
+    // 2 MiB 以上の領域は 2 MiB 境界に置いて madvise(MADV_HUGEPAGE) でヒュージページを要求し,
+    // それより小さい領域は 64 バイト (キャッシュライン) 境界に置くアロケータ
+    // カーネルがヒュージページに対応していなければ通常のページのまま使う
+    template <typename T>
+    struct huge_page_allocator {
+        using value_type = T;
+
+        static constexpr std::size_t huge_page_size = std::size_t(1) << 21;
+        static constexpr std::size_t cache_line_size = 64;
+
+        static_assert(alignof(T) <= cache_line_size);
+
+        huge_page_allocator() noexcept = default;
+
+        template <typename U>
+        huge_page_allocator(const huge_page_allocator<U> &) noexcept {
+        }
+
+    public:
+        T *allocate(std::size_t n) {
+            auto bytes = n * sizeof(T);
+            auto align = huge_page_size <= bytes ? huge_page_size : cache_line_size;
+            bytes = (bytes + align - 1) / align * align;
+            if (bytes == 0) {
+                bytes = align;
+            }
+
+            auto p = std::aligned_alloc(align, bytes);
+            if (p == nullptr) {
+                throw std::bad_alloc();
+            }
+
+#ifdef MADV_HUGEPAGE
+            if (align == huge_page_size) {
+                // 失敗しても通常のページで動く
+                madvise(p, bytes, MADV_HUGEPAGE);
+            }
+#endif
+
+            return static_cast<T *>(p);
+        }
+
+        void deallocate(T *p, std::size_t) noexcept {
+            std::free(p);
+        }
+
+        template <typename U>
+        friend bool operator==(const huge_page_allocator &, const huge_page_allocator<U> &) noexcept {
+            return true;
+        }
+        template <typename U>
+        friend bool operator!=(const huge_page_allocator &, const huge_page_allocator<U> &) noexcept {
+            return false;
+        }
+    };
+}
+
+#endif // STCP_HUGE_PAGE_ALLOCATOR_HPP
@@ -0,0 +1,161 @@
+#ifndef STCP_INTERVAL_MAP_HPP
+#define STCP_INTERVAL_MAP_HPP
+
+#include <utility>
+#include <iterator>
+#include <optional>
+#include <algorithm>
+#include <map>
+#include <cassert>
+#include <cstddef>
+
+namespace stcp {
+    // 互いに重ならない区間 [l, r) にそれぞれ値を持たせた集合を管理する (l < r)
+    // segment_set と同じ split / clear / connect を持ち, 値の等しい隣接区間は assign で結合される
+    template <typename Int, typename V>
+    struct interval_map {
+        using int_type = Int;
+        using value_type = V;
+
+        interval_map(): seg_() {
+        }
+
+    public:
+        // amortized O(log n)
+        // 区間 [l, r) に v を割り当てる
+        // 境界で接し, 値の等しい区間とは結合する
+        void assign(int_type l, int_type r, V v) {
+            assert(l <= r);
+
+            if (l == r) {
+                return;
+            }
+
+            clear(l, r);
+
+            auto iter = seg_.emplace_hint(seg_.lower_bound(r), l, run{ r, std::move(v) });
+
+            if (auto next = std::next(iter); next != std::end(seg_)) {
+                connect(next->first);
+            }
+            connect(l);
+        }
+
+        // 要素 [x, k), [k, y) の値が等しければ [x, y) へマージする
+        void connect(int_type k) {
+            auto iter1 = seg_.lower_bound(k);
+
+            if (iter1 == std::begin(seg_) || iter1 == std::end(seg_)) {
+                return;
+            }
+
+            auto iter2 = std::prev(iter1);
+
+            if (iter2->second.r == k && iter1->first == k && iter2->second.value == iter1->second.value) {
+                iter2->second.r = iter1->second.r;
+                seg_.erase(iter1);
+            }
+        }
+
+        // 要素 [x, y) を値を保ったまま [x, k), [k, y) に分割
+        void split(int_type k) {
+            auto iter = seg_.upper_bound(k);
+
+            if (iter == std::begin(seg_)) {
+                return;
+            }
+            std::advance(iter, -1);
+
+            if (k == iter->first || iter->second.r <= k) {
+                return;
+            }
+
+            seg_.emplace_hint(std::next(iter), k, iter->second);
+            iter->second.r = k;
+        }
+
+        // 集合から [l, r) に重なる部分を *切り取り* 削除する
+        void clear(int_type l, int_type r) {
+            assert(l <= r);
+
+            split(l);
+            split(r);
+
+            seg_.erase(seg_.lower_bound(l), seg_.lower_bound(r));
+        }
+
+        // 存在するのなら l <= k < r な区間 [l, r) を返す
+        std::optional<std::pair<int_type, int_type>> wrapped(int_type k) const {
+            auto iter = find(k);
+
+            if (iter == std::end(seg_)) {
+                return std::nullopt;
+            }
+
+            return std::make_pair(iter->first, iter->second.r);
+        }
+
+        // k を含む区間の値を取得する
+        std::optional<V> get(int_type k) const {
+            auto iter = find(k);
+
+            if (iter == std::end(seg_)) {
+                return std::nullopt;
+            }
+
+            return iter->second.value;
+        }
+
+        // [l, r) に重なる区間を左から順に [l, r) へ切り詰めて f(l', r', v) で列挙する
+        template <typename F>
+        void visit(int_type l, int_type r, F f) const {
+            assert(l <= r);
+
+            if (l == r) {
+                return;
+            }
+
+            auto iter = seg_.upper_bound(l);
+
+            if (iter != std::begin(seg_) && l < std::prev(iter)->second.r) {
+                std::advance(iter, -1);
+            }
+
+            while (iter != std::end(seg_) && iter->first < r) {
+                f(std::max(l, iter->first), std::min(r, iter->second.r), iter->second.value);
+                std::advance(iter, +1);
+            }
+        }
+
+        // 区間の個数
+        std::size_t size() const noexcept {
+            return seg_.size();
+        }
+
+    private:
+        struct run {
+            int_type r;
+            V value;
+        };
+
+        auto find(int_type k) const {
+            auto iter = seg_.upper_bound(k);
+
+            if (iter == std::begin(seg_)) {
+                return std::end(seg_);
+            }
+            std::advance(iter, -1);
+
+            if (iter->second.r <= k) {
+                return std::end(seg_);
+            }
+
+            return iter;
+        }
+
+    private:
+        std::map<int_type, run> seg_;
+    };
+}
+
+#endif // STCP_INTERVAL_MAP_HPP
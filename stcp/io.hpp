@@ -0,0 +1,312 @@
+#ifndef STCP_IO_HPP
+#define STCP_IO_HPP
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace stcp {
+    // ファイル記述子から整数や文字列を読む
+    // 通常のファイルは mmap し, それ以外 (パイプなど) は大きなブロックごとに read する
+    // 8 桁ずつまとめて SWAR で変換する
+    struct reader {
+        // O(1) (mmap) / O(buffer_size)
+        explicit reader(int fd = 0):
+            fd_(fd) {
+
+            struct stat st;
+            if (fstat(fd_, &st) == 0 && S_ISREG(st.st_mode) && 0 < st.st_size) {
+                auto p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd_, 0);
+                if (p != MAP_FAILED) {
+                    map_ = static_cast<char *>(p);
+                    map_size_ = st.st_size;
+                    first_ = map_;
+                    last_ = map_ + map_size_;
+                    eof_ = true;
+                    return;
+                }
+            }
+
+            buf_ = new char[buffer_size];
+            first_ = last_ = buf_;
+            fill();
+        }
+
+        reader(const reader &) = delete;
+        reader &operator=(const reader &) = delete;
+
+        ~reader() {
+            if (map_ != nullptr) {
+                munmap(map_, map_size_);
+            }
+            delete[] buf_;
+        }
+
+    public:
+        // 空白以外の文字が残っていないか
+        bool eof() {
+            skip();
+            return first_ == last_;
+        }
+
+        template <typename T>
+        T read() {
+            T x;
+            *this >> x;
+            return x;
+        }
+
+        // 先頭の空白を読み飛ばして符号付き / 符号なし整数を読む
+        template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, char> && !std::is_same_v<T, bool>, std::nullptr_t> = nullptr>
+        reader &operator>>(T &x) {
+            skip();
+            reserve(max_token);
+
+            bool neg = false;
+            if constexpr (std::is_signed_v<T>) {
+                neg = first_ != last_ && *first_ == '-';
+                first_ += neg;
+            }
+
+            using U = std::make_unsigned_t<T>;
+            U v = 0;
+
+            while (8 <= last_ - first_) {
+                std::uint64_t w;
+                std::memcpy(&w, first_, 8);
+                if (!all_digits(w)) {
+                    break;
+                }
+                v = v * 100000000 + U(parse8(w));
+                first_ += 8;
+            }
+            while (first_ != last_ && unsigned(*first_ - '0') < 10) {
+                v = v * 10 + U(*first_++ - '0');
+            }
+
+            x = neg ? T(-v) : T(v);
+            return *this;
+        }
+
+        // 空白以外の 1 文字を読む
+        reader &operator>>(char &c) {
+            skip();
+            c = first_ != last_ ? *first_++ : '\0';
+            return *this;
+        }
+
+        // 空白で区切られた文字列を読む
+        reader &operator>>(std::string &s) {
+            skip();
+            s.clear();
+
+            while (true) {
+                auto p = std::find_if(first_, last_, [](char c) {
+                    return is_space(c);
+                });
+                s.append(first_, p);
+                first_ = p;
+
+                if (first_ != last_ || eof_) {
+                    break;
+                }
+                fill();
+            }
+
+            return *this;
+        }
+
+    private:
+        static constexpr std::size_t buffer_size = 1 << 17;
+
+        // 整数 1 つ分として先読みしておく長さ
+        static constexpr std::ptrdiff_t max_token = 64;
+
+        static bool is_space(char c) {
+            return unsigned(c) <= ' ';
+        }
+
+        // 8 バイトすべてが '0' から '9' か
+        static bool all_digits(std::uint64_t w) {
+            return ((w & 0xF0F0F0F0F0F0F0F0) | (((w + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333;
+        }
+
+        // リトルエンディアンで並んだ 8 桁を数値にする
+        static std::uint32_t parse8(std::uint64_t w) {
+            w -= 0x3030303030303030;
+            w = (w * 10) + (w >> 8);
+            w = (((w & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+                 (((w >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+            return std::uint32_t(w);
+        }
+
+        void skip() {
+            while (true) {
+                while (first_ != last_ && is_space(*first_)) {
+                    ++first_;
+                }
+                if (first_ != last_ || eof_) {
+                    return;
+                }
+                fill();
+            }
+        }
+
+        // 末尾でなければ n バイト以上読める状態にする
+        void reserve(std::ptrdiff_t n) {
+            while (last_ - first_ < n && !eof_) {
+                fill();
+            }
+        }
+
+        // 残りを先頭に寄せて続きを読む
+        void fill() {
+            auto rest = last_ - first_;
+            std::memmove(buf_, first_, rest);
+            first_ = buf_;
+            last_ = buf_ + rest;
+
+            auto n = ::read(fd_, buf_ + rest, buffer_size - rest);
+            if (n <= 0) {
+                eof_ = true;
+                return;
+            }
+            last_ += n;
+        }
+
+    private:
+        int fd_;
+        char *map_ = nullptr;
+        std::size_t map_size_ = 0;
+        char *buf_ = nullptr;
+        const char *first_ = nullptr, *last_ = nullptr;
+        bool eof_ = false;
+    };
+
+    // ファイル記述子へまとめて書き出す
+    // 整数は 2 桁ずつ表を引いて文字列にする
+    struct writer {
+        // O(1)
+        explicit writer(int fd = 1):
+            fd_(fd), buf_(new char[buffer_size]), last_(buf_) {
+        }
+
+        writer(const writer &) = delete;
+        writer &operator=(const writer &) = delete;
+
+        ~writer() {
+            flush();
+            delete[] buf_;
+        }
+
+    public:
+        void flush() {
+            auto p = buf_;
+            while (p != last_) {
+                auto n = ::write(fd_, p, last_ - p);
+                if (n <= 0) {
+                    break;
+                }
+                p += n;
+            }
+            last_ = buf_;
+        }
+
+        template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, char> && !std::is_same_v<T, bool>, std::nullptr_t> = nullptr>
+        writer &operator<<(T x) {
+            reserve(max_token);
+
+            using U = std::make_unsigned_t<T>;
+            U v = U(x);
+            if constexpr (std::is_signed_v<T>) {
+                if (x < 0) {
+                    *last_++ = '-';
+                    v = U(0) - v;
+                }
+            }
+
+            char tmp[24];
+            auto p = tmp + sizeof(tmp);
+            while (100 <= v) {
+                p -= 2;
+                std::memcpy(p, digits2 + 2 * (v % 100), 2);
+                v /= 100;
+            }
+            if (10 <= v) {
+                p -= 2;
+                std::memcpy(p, digits2 + 2 * v, 2);
+            }
+            else {
+                *--p = char('0' + v);
+            }
+
+            auto n = tmp + sizeof(tmp) - p;
+            std::memcpy(last_, p, n);
+            last_ += n;
+
+            return *this;
+        }
+
+        writer &operator<<(char c) {
+            reserve(1);
+            *last_++ = c;
+            return *this;
+        }
+
+        writer &operator<<(std::string_view s) {
+            while (!s.empty()) {
+                reserve(1);
+                auto n = std::min<std::size_t>(s.size(), buf_ + buffer_size - last_);
+                std::memcpy(last_, s.data(), n);
+                last_ += n;
+                s.remove_prefix(n);
+            }
+            return *this;
+        }
+
+        writer &operator<<(const char *s) {
+            return *this << std::string_view(s);
+        }
+
+        writer &operator<<(const std::string &s) {
+            return *this << std::string_view(s);
+        }
+
+    private:
+        static constexpr std::size_t buffer_size = 1 << 17;
+        static constexpr std::ptrdiff_t max_token = 24;
+
+        static constexpr char digits2[] =
+            "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899";
+
+        void reserve(std::ptrdiff_t n) {
+            if (buf_ + buffer_size - last_ < n) {
+                flush();
+            }
+        }
+
+    private:
+        int fd_;
+        char *buf_, *last_;
+    };
+}
+
+#endif // STCP_IO_HPP
@@ -4,13 +4,18 @@
 #include <type_traits>
 #include <utility>
 #include <vector>
+#include <memory>
 #include <cassert>
 #include <cstddef>
+#include "stcp/stats.hpp"
 
 namespace stcp {
-    template <typename S, S (*Op)(S, S), S (*E)(), typename F, S (*Mapping)(F, S), F (*Composition)(F, F), F (*Id)()>
-    struct lazy_segment_tree {
+    // 節点と遅延作用の列は Allocator (を rebind したもの) で確保する
+    // STCP_ENABLE_STATS のとき stats() で Op の呼び出し・節点の訪問・遅延作用を下ろした回数・確保の回数を返す
+    template <typename S, S (*Op)(S, S), S (*E)(), typename F, S (*Mapping)(F, S), F (*Composition)(F, F), F (*Id)(), typename Allocator = std::allocator<S>>
+    struct lazy_segment_tree: stats_recorder<lazy_segment_tree<S, Op, E, F, Mapping, Composition, Id, Allocator>> {
         using value_type = S;
+        using allocator_type = Allocator;
 
         // O(1)
         lazy_segment_tree():
@@ -18,28 +23,28 @@ namespace stcp {
         }
 
         // O(n)
-        explicit lazy_segment_tree(std::size_t n):
-            n_(n) {
+        explicit lazy_segment_tree(std::size_t n, const Allocator &alloc = Allocator()):
+            data_(alloc), lazy_(alloc), n_(n) {
             log_ = 0;
             while ((std::size_t(1) << log_) < n_) {
                 ++log_;
             }
             size_ = (1 << log_);
 
-            data_ = std::vector<S>(size_ + size_, E());
-            lazy_ = std::vector<F>(size_, Id());
+            data_.assign(size_ + size_, E());
+            lazy_.assign(size_, Id());
         }
 
         // O(size(v))
-        explicit lazy_segment_tree(const std::vector<S> &v):
-            n_(v.size()) {
+        explicit lazy_segment_tree(const std::vector<S> &v, const Allocator &alloc = Allocator()):
+            data_(alloc), lazy_(alloc), n_(v.size()) {
             log_ = 0;
             while ((std::size_t(1) << log_) < n_) {
                 ++log_;
             }
             size_ = (1 << log_);
 
-            data_ = std::vector<S>(size_ + size_, E());
+            data_.assign(size_ + size_, E());
             for (std::size_t i = 0; i < n_; ++i) {
                 data_[i + size_] = v[i];
             }
@@ -48,14 +53,14 @@ namespace stcp {
                 update_data(i);
             }
 
-            lazy_ = std::vector<F>(size_, Id());
+            lazy_.assign(size_, Id());
         }
 
     public:
         // O(log size(lazy_segment_tree))
         // 0 <= i < size(lazy_segment_tree)
         void set(std::size_t i, S x) {
-            assert(0 <= i && i < n_);
+            assert(i < n_);
 
             i += size_;
             for (auto j = log_; 1 <= j; --j) {
@@ -64,6 +69,7 @@ namespace stcp {
 
             data_[i] = x; i >>= 1;
             while (1 <= i) {
+                recorder::count_visit();
                 update_data(i); i >>= 1;
             }
         }
@@ -71,7 +77,7 @@ namespace stcp {
         // O(log size(lazy_segment_tree))
         // 0 <= i < size(lazy_segment_tree)
         S get(std::size_t i) const {
-            assert(0 <= i && i < n_);
+            assert(i < n_);
 
             i += size_;
             for (auto j = log_; 1 <= j; --j) {
@@ -84,7 +90,7 @@ namespace stcp {
         // O(log size(lazy_segment_tree))
         // 0 <= l <= r <= size(lazy_segment_tree)
         S prod(std::size_t l, std::size_t r) const {
-            assert(0 <= l && l <= r && r <= n_);
+            assert(l <= r && r <= n_);
 
             if (l == r) {
                 return E();
@@ -102,16 +108,17 @@ namespace stcp {
 
             S accl = E(), accr = E();
             while (l < r) {
+                recorder::count_visit();
                 if (l & 1) {
-                    accl = Op(accl, data_[l++]);
+                    accl = op(accl, data_[l++]);
                 }
                 if (r & 1) {
-                    accr = Op(data_[--r], accr);
+                    accr = op(data_[--r], accr);
                 }
                 l >>= 1; r >>= 1;
             }
 
-            return Op(accl, accr);
+            return op(accl, accr);
         }
 
         // O(1)
@@ -122,7 +129,7 @@ namespace stcp {
         // O(log size(lazy_segment_tree))
         // 0 <= l <= r <= size(lazy_segment_tree)
         void apply(std::size_t l, std::size_t r, F f) {
-            assert(0 <= l && l <= r && r <= n_);
+            assert(l <= r && r <= n_);
 
             if (l == r) {
                 return;
@@ -140,6 +147,7 @@ namespace stcp {
 
             auto pl = l, pr = r;
             while (l < r) {
+                recorder::count_visit();
                 if (l & 1) {
                     push_lazy(l++, f);
                 }
@@ -165,7 +173,7 @@ namespace stcp {
         std::size_t max_right(std::size_t l, G &&f) const {
             static_assert(std::is_invocable_r_v<bool, G, S>);
 
-            assert(0 <= l && l <= n_);
+            assert(l <= n_);
             assert(std::forward<G>(f)(E()));
 
             if (l == n_) {
@@ -179,7 +187,8 @@ namespace stcp {
 
             S acc = E();
             while (((l & (l << 1)) | 1) != l) {
-                if (S con = Op(acc, data_[l]); std::forward<G>(f)(con)) {
+                recorder::count_visit();
+                if (S con = op(acc, data_[l]); std::forward<G>(f)(con)) {
                     if (l & 1) {
                         acc = con; ++l;
                     }
@@ -189,13 +198,14 @@ namespace stcp {
                 break;
             }
 
-            if (std::forward<G>(f)(Op(acc, data_[l]))) {
+            if (std::forward<G>(f)(op(acc, data_[l]))) {
                 return n_;
             }
 
             while (l < size_) {
+                recorder::count_visit();
                 apply_lazy(l); l <<= 1;
-                if (S con = Op(acc, data_[l]); std::forward<G>(f)(con)) {
+                if (S con = op(acc, data_[l]); std::forward<G>(f)(con)) {
                     acc = con; ++l;
                 }
             }
@@ -209,7 +219,7 @@ namespace stcp {
         std::size_t min_left(std::size_t r, G &&f) const {
             static_assert(std::is_invocable_r_v<bool, G, S>);
 
-            assert(0 <= r && r <= n_);
+            assert(r <= n_);
             assert(std::forward<G>(f)(E()));
 
             if (r == 0) {
@@ -223,7 +233,8 @@ namespace stcp {
 
             S acc = E();
             while ((r & -r) != r) {
-                if (S con = Op(data_[r], acc); std::forward<G>(f)(con)) {
+                recorder::count_visit();
+                if (S con = op(data_[r], acc); std::forward<G>(f)(con)) {
                     if ((r & 1) == 0) {
                         acc = con; --r;
                     }
@@ -233,13 +244,14 @@ namespace stcp {
                 break;
             }
 
-            if (std::forward<G>(f)(Op(data_[r], acc))) {
+            if (std::forward<G>(f)(op(data_[r], acc))) {
                 return 0;
             }
 
             while (r < size_) {
+                recorder::count_visit();
                 apply_lazy(r); r <<= 1; ++r;
-                if (S con = Op(data_[r], acc); std::forward<G>(f)(con)) {
+                if (S con = op(data_[r], acc); std::forward<G>(f)(con)) {
                     acc = con; --r;
                 }
             }
@@ -248,7 +260,15 @@ namespace stcp {
         }
 
     private:
+        using recorder = stats_recorder<lazy_segment_tree>;
+
+        static S op(S x, S y) {
+            recorder::count_op();
+            return Op(x, y);
+        }
+
         void apply_lazy(std::size_t i) const {
+            recorder::count_push();
             push_lazy(i + i, lazy_[i]);
             push_lazy(i + i + 1, lazy_[i]);
             lazy_[i] = Id();
@@ -261,12 +281,12 @@ namespace stcp {
         }
 
         void update_data(std::size_t i) const {
-            data_[i] = Op(data_[i + i], data_[i + i + 1]);
+            data_[i] = op(data_[i + i], data_[i + i + 1]);
         }
 
     private:
-        mutable std::vector<S> data_;
-        mutable std::vector<F> lazy_;
+        mutable std::vector<S, Allocator> data_;
+        mutable std::vector<F, typename std::allocator_traits<Allocator>::template rebind_alloc<F>> lazy_;
         std::size_t n_, size_, log_;
     };
 }
@@ -0,0 +1,259 @@
+#ifndef STCP_MODINT_HPP
+#define STCP_MODINT_HPP
+
+#include <utility>
+#include <type_traits>
+#include <cassert>
+#include <cstdint>
+
+namespace stcp {
+    // 法 Mod (奇数, Mod < 2^30) をコンパイル時に固定した Montgomery 表現の剰余環の元
+    // 値 x を x * 2^32 mod Mod と合同な [0, 2 Mod) の数として持ち, 乗算から除算と分岐をなくす
+    template <std::uint32_t Mod>
+    struct montgomery_modint {
+        static_assert(Mod % 2 == 1 && Mod < (std::uint32_t(1) << 30));
+
+        using self = montgomery_modint;
+
+        constexpr montgomery_modint() noexcept:
+            x_(0) {
+        }
+
+        template <typename T, std::enable_if_t<std::is_integral_v<T>, std::nullptr_t> = nullptr>
+        constexpr montgomery_modint(T v) noexcept:
+            x_(reduce(std::uint64_t(normalize(v)) * r2)) {
+        }
+
+    public:
+        static constexpr std::uint32_t mod() noexcept {
+            return Mod;
+        }
+
+        // O(1)
+        constexpr std::uint32_t val() const noexcept {
+            auto x = reduce(x_);
+            return Mod <= x ? x - Mod : x;
+        }
+
+        constexpr self &operator+=(self y) noexcept {
+            x_ += y.x_;
+            if (2 * Mod <= x_) {
+                x_ -= 2 * Mod;
+            }
+            return *this;
+        }
+        constexpr self &operator-=(self y) noexcept {
+            x_ += 2 * Mod - y.x_;
+            if (2 * Mod <= x_) {
+                x_ -= 2 * Mod;
+            }
+            return *this;
+        }
+        constexpr self &operator*=(self y) noexcept {
+            x_ = reduce(std::uint64_t(x_) * y.x_);
+            return *this;
+        }
+        // Mod が素数であること
+        constexpr self &operator/=(self y) noexcept {
+            return *this *= y.inv();
+        }
+
+        constexpr self operator+() const noexcept {
+            return *this;
+        }
+        constexpr self operator-() const noexcept {
+            return self() - *this;
+        }
+
+        friend constexpr self operator+(self x, self y) noexcept { return x += y; }
+        friend constexpr self operator-(self x, self y) noexcept { return x -= y; }
+        friend constexpr self operator*(self x, self y) noexcept { return x *= y; }
+        friend constexpr self operator/(self x, self y) noexcept { return x /= y; }
+        friend constexpr bool operator==(self x, self y) noexcept { return x.canonical() == y.canonical(); }
+        friend constexpr bool operator!=(self x, self y) noexcept { return x.canonical() != y.canonical(); }
+
+        // O(log k)
+        constexpr self pow(std::uint64_t k) const noexcept {
+            self acc = 1, y = *this;
+            for (; 0 < k; k >>= 1) {
+                if (k & 1) {
+                    acc *= y;
+                }
+                y *= y;
+            }
+            return acc;
+        }
+
+        // O(log Mod)
+        // Mod が素数であること
+        constexpr self inv() const noexcept {
+            assert(canonical() != 0);
+            return pow(Mod - 2);
+        }
+
+    private:
+        template <typename T>
+        static constexpr std::uint32_t normalize(T v) noexcept {
+            if constexpr (std::is_signed_v<T>) {
+                auto r = std::int64_t(v % std::int64_t(Mod));
+                return std::uint32_t(r < 0 ? r + Mod : r);
+            }
+            else {
+                return std::uint32_t(std::uint64_t(v) % Mod);
+            }
+        }
+
+        // -Mod^{-1} mod 2^32 (Newton 法)
+        static constexpr std::uint32_t neg_inv() noexcept {
+            std::uint32_t x = Mod;
+            for (int i = 0; i < 5; ++i) {
+                x *= 2 - Mod * x;
+            }
+            return -x;
+        }
+
+        // t / 2^32 と合同な [0, 2 Mod) の数 (t < Mod * 2^32)
+        static constexpr std::uint32_t reduce(std::uint64_t t) noexcept {
+            auto m = std::uint32_t(t) * n_inv;
+            return std::uint32_t((t + std::uint64_t(m) * Mod) >> 32);
+        }
+
+        constexpr std::uint32_t canonical() const noexcept {
+            return Mod <= x_ ? x_ - Mod : x_;
+        }
+
+        static constexpr std::uint32_t n_inv = neg_inv();
+        // 2^64 mod Mod
+        static constexpr std::uint32_t r2 = std::uint32_t(-std::uint64_t(Mod) % Mod);
+
+    private:
+        std::uint32_t x_;
+    };
+
+    // 法を実行時に set_mod で決める剰余環の元 (1 <= mod < 2^31)
+    // 乗算の剰余は Barrett reduction で 128 bit の乗算に置き換える
+    // 法は Id ごとに共有される
+    template <int Id>
+    struct barrett_modint {
+        using self = barrett_modint;
+
+        constexpr barrett_modint() noexcept:
+            x_(0) {
+        }
+
+        template <typename T, std::enable_if_t<std::is_integral_v<T>, std::nullptr_t> = nullptr>
+        barrett_modint(T v) noexcept:
+            x_(normalize(v)) {
+        }
+
+    public:
+        static void set_mod(std::uint32_t m) noexcept {
+            assert(1 <= m && m < (std::uint32_t(1) << 31));
+
+            mod_ = m;
+            im_ = ~std::uint64_t(0) / m + 1;
+        }
+
+        static std::uint32_t mod() noexcept {
+            return mod_;
+        }
+
+        // O(1)
+        std::uint32_t val() const noexcept {
+            return x_;
+        }
+
+        self &operator+=(self y) noexcept {
+            x_ += y.x_;
+            if (mod_ <= x_) {
+                x_ -= mod_;
+            }
+            return *this;
+        }
+        self &operator-=(self y) noexcept {
+            x_ += mod_ - y.x_;
+            if (mod_ <= x_) {
+                x_ -= mod_;
+            }
+            return *this;
+        }
+        self &operator*=(self y) noexcept {
+            x_ = mul(x_, y.x_);
+            return *this;
+        }
+        self &operator/=(self y) noexcept {
+            return *this *= y.inv();
+        }
+
+        self operator+() const noexcept {
+            return *this;
+        }
+        self operator-() const noexcept {
+            return self() - *this;
+        }
+
+        friend self operator+(self x, self y) noexcept { return x += y; }
+        friend self operator-(self x, self y) noexcept { return x -= y; }
+        friend self operator*(self x, self y) noexcept { return x *= y; }
+        friend self operator/(self x, self y) noexcept { return x /= y; }
+        friend bool operator==(self x, self y) noexcept { return x.x_ == y.x_; }
+        friend bool operator!=(self x, self y) noexcept { return x.x_ != y.x_; }
+
+        // O(log k)
+        self pow(std::uint64_t k) const noexcept {
+            self acc = 1, y = *this;
+            for (; 0 < k; k >>= 1) {
+                if (k & 1) {
+                    acc *= y;
+                }
+                y *= y;
+            }
+            return acc;
+        }
+
+        // O(log mod)
+        // gcd(val, mod) = 1 であること
+        self inv() const noexcept {
+            std::int64_t a = x_, b = mod_, u = 1, v = 0;
+            while (b != 0) {
+                auto t = a / b;
+                a -= t * b; std::swap(a, b);
+                u -= t * v; std::swap(u, v);
+            }
+            assert(a == 1);
+            return self(u);
+        }
+
+    private:
+        template <typename T>
+        static std::uint32_t normalize(T v) noexcept {
+            if constexpr (std::is_signed_v<T>) {
+                auto r = std::int64_t(v % std::int64_t(mod_));
+                return std::uint32_t(r < 0 ? r + mod_ : r);
+            }
+            else {
+                return std::uint32_t(std::uint64_t(v) % mod_);
+            }
+        }
+
+        // a * b mod mod_ (a, b < mod_)
+        static std::uint32_t mul(std::uint32_t a, std::uint32_t b) noexcept {
+            auto z = std::uint64_t(a) * b;
+            auto q = std::uint64_t((unsigned __int128)(z) * im_ >> 64);
+            auto r = std::uint32_t(z - q * mod_);
+            return mod_ <= r ? r + mod_ : r;
+        }
+
+        static inline std::uint32_t mod_ = 998244353;
+        static inline std::uint64_t im_ = ~std::uint64_t(0) / 998244353 + 1;
+
+    private:
+        std::uint32_t x_;
+    };
+
+    using modint998244353 = montgomery_modint<998244353>;
+    using modint1000000007 = montgomery_modint<1000000007>;
+    using modint = barrett_modint<-1>;
+}
+
+#endif // STCP_MODINT_HPP
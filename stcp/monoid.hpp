@@ -0,0 +1,198 @@
+#ifndef STCP_MONOID_HPP
+#define STCP_MONOID_HPP
+
+#include <type_traits>
+#include <optional>
+#include <numeric>
+#include <limits>
+
+namespace stcp {
+    // モノイド M は value_type, op, e を持つ (op, e は segment_tree の Op, E にそのまま渡せる)
+    // 可換なら commutative, 冪等 (op(x, x) = x) なら idempotent を true にし, 逆元があれば inv を持つ
+    // (idempotent なら segment_tree_of の点更新が値の変わらない祖先で止まる)
+    //
+    // 作用 A は value_type, action_type, mapping, composition, id を持つ
+    // composition(f, g) は g の後に f を作用させる写像 (lazy_segment_tree と同じ向き)
+    // composition が可換なら commutative を true にする (dual_segment_tree_of が作用を下ろさなくなる)
+
+    template <typename T>
+    struct sum_monoid {
+        using value_type = T;
+        static constexpr bool commutative = true, idempotent = false;
+
+        static constexpr T op(T x, T y) { return x + y; }
+        static constexpr T e() { return T(0); }
+        static constexpr T inv(T x) { return -x; }
+    };
+
+    template <typename T>
+    struct min_monoid {
+        using value_type = T;
+        static constexpr bool commutative = true, idempotent = true;
+
+        static constexpr T op(T x, T y) { return y < x ? y : x; }
+        static constexpr T e() { return std::numeric_limits<T>::max(); }
+    };
+
+    template <typename T>
+    struct max_monoid {
+        using value_type = T;
+        static constexpr bool commutative = true, idempotent = true;
+
+        static constexpr T op(T x, T y) { return x < y ? y : x; }
+        static constexpr T e() { return std::numeric_limits<T>::lowest(); }
+    };
+
+    template <typename T>
+    struct xor_monoid {
+        using value_type = T;
+        static constexpr bool commutative = true, idempotent = false;
+
+        static constexpr T op(T x, T y) { return x ^ y; }
+        static constexpr T e() { return T(0); }
+        static constexpr T inv(T x) { return x; }
+    };
+
+    template <typename T>
+    struct gcd_monoid {
+        using value_type = T;
+        static constexpr bool commutative = true, idempotent = true;
+
+        static constexpr T op(T x, T y) { return std::gcd(x, y); }
+        static constexpr T e() { return T(0); }
+    };
+
+    // x -> a x + b
+    template <typename T>
+    struct affine {
+        T a, b;
+
+        constexpr T operator()(T x) const { return a * x + b; }
+    };
+
+    // op(f, g) は f, g の順に作用させる写像
+    template <typename T>
+    struct affine_monoid {
+        using value_type = affine<T>;
+        static constexpr bool commutative = false, idempotent = false;
+
+        static constexpr value_type op(value_type f, value_type g) { return { f.a * g.a, f.b * g.a + g.b }; }
+        static constexpr value_type e() { return { T(1), T(0) }; }
+    };
+
+    // 値があれば後ろのもの, なければ前のもの
+    template <typename T>
+    struct assign_monoid {
+        using value_type = std::optional<T>;
+        static constexpr bool commutative = false, idempotent = true;
+
+        static constexpr value_type op(value_type x, value_type y) { return y.has_value() ? y : x; }
+        static constexpr value_type e() { return std::nullopt; }
+    };
+
+    // 区間和に区間の長さを添えたもの (区間への作用に長さが必要な場合)
+    template <typename T>
+    struct sum_size {
+        T sum, size;
+    };
+
+    template <typename T>
+    struct sum_size_monoid {
+        using value_type = sum_size<T>;
+        static constexpr bool commutative = true, idempotent = false;
+
+        static constexpr value_type op(value_type x, value_type y) { return { x.sum + y.sum, x.size + y.size }; }
+        static constexpr value_type e() { return { T(0), T(0) }; }
+        static constexpr value_type inv(value_type x) { return { -x.sum, -x.size }; }
+    };
+
+    // x -> x + f (min_monoid, max_monoid や dual_segment_tree の各点に)
+    template <typename T>
+    struct add_action {
+        using value_type = T;
+        using action_type = T;
+        static constexpr bool commutative = true;
+
+        static constexpr T mapping(T f, T x) { return x + f; }
+        static constexpr T composition(T f, T g) { return f + g; }
+        static constexpr T id() { return T(0); }
+    };
+
+    // 区間の各点に f を足す (sum_size_monoid に)
+    template <typename T>
+    struct add_sum_action {
+        using value_type = sum_size<T>;
+        using action_type = T;
+        static constexpr bool commutative = true;
+
+        static constexpr value_type mapping(T f, value_type x) { return { x.sum + f * x.size, x.size }; }
+        static constexpr T composition(T f, T g) { return f + g; }
+        static constexpr T id() { return T(0); }
+    };
+
+    // 区間の各点に x -> a x + b を作用させる (sum_size_monoid に)
+    template <typename T>
+    struct affine_action {
+        using value_type = sum_size<T>;
+        using action_type = affine<T>;
+        static constexpr bool commutative = false;
+
+        static constexpr value_type mapping(action_type f, value_type x) { return { f.a * x.sum + f.b * x.size, x.size }; }
+        static constexpr action_type composition(action_type f, action_type g) { return affine_monoid<T>::op(g, f); }
+        static constexpr action_type id() { return affine_monoid<T>::e(); }
+    };
+
+    // 各点を f で置き換える (min_monoid, max_monoid や dual_segment_tree の各点に)
+    template <typename T>
+    struct assign_action {
+        using value_type = T;
+        using action_type = std::optional<T>;
+        static constexpr bool commutative = false;
+
+        static constexpr T mapping(action_type f, T x) { return f.has_value() ? *f : x; }
+        static constexpr action_type composition(action_type f, action_type g) { return f.has_value() ? f : g; }
+        static constexpr action_type id() { return std::nullopt; }
+    };
+
+    // 区間の各点を f で置き換える (sum_size_monoid に)
+    template <typename T>
+    struct assign_sum_action {
+        using value_type = sum_size<T>;
+        using action_type = std::optional<T>;
+        static constexpr bool commutative = false;
+
+        static constexpr value_type mapping(action_type f, value_type x) { return f.has_value() ? value_type{ *f * x.size, x.size } : x; }
+        static constexpr action_type composition(action_type f, action_type g) { return f.has_value() ? f : g; }
+        static constexpr action_type id() { return std::nullopt; }
+    };
+
+    template <typename M, typename = void>
+    struct is_commutative: std::false_type {
+    };
+    template <typename M>
+    struct is_commutative<M, std::void_t<decltype(M::commutative)>>: std::bool_constant<M::commutative> {
+    };
+
+    template <typename M, typename = void>
+    struct is_idempotent: std::false_type {
+    };
+    template <typename M>
+    struct is_idempotent<M, std::void_t<decltype(M::idempotent)>>: std::bool_constant<M::idempotent> {
+    };
+
+    template <typename M, typename = void>
+    struct has_inverse: std::false_type {
+    };
+    template <typename M>
+    struct has_inverse<M, std::void_t<decltype(M::inv(std::declval<typename M::value_type>()))>>: std::true_type {
+    };
+
+    template <typename M>
+    constexpr bool is_commutative_v = is_commutative<M>::value;
+    template <typename M>
+    constexpr bool is_idempotent_v = is_idempotent<M>::value;
+    template <typename M>
+    constexpr bool has_inverse_v = has_inverse<M>::value;
+}
+
+#endif // STCP_MONOID_HPP
@@ -4,16 +4,143 @@
 #include <utility>
 #include <iterator>
 #include <optional>
+#include <algorithm>
+#include <vector>
 #include <map>
+#include <memory>
+#include <limits>
 #include <cassert>
+#include <cstddef>
+#include "stcp/dynamic_segment_tree.hpp"
 
 namespace stcp {
+    // キーでソートされた std::vector による std::map の代替 (segment_set が使う範囲のみ)
+    // 探索は連続領域上の二分探索, 挿入・削除は要素の移動になる
+    template <typename Key, typename T, typename Allocator = std::allocator<std::pair<Key, T>>>
+    struct flat_map {
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<Key, T>;
+        using allocator_type = Allocator;
+        using iterator = typename std::vector<value_type, Allocator>::iterator;
+        using const_iterator = typename std::vector<value_type, Allocator>::const_iterator;
+
+        flat_map(): data_() {
+        }
+
+        explicit flat_map(const Allocator &alloc): data_(alloc) {
+        }
+
+    public:
+        iterator begin() noexcept {
+            return std::begin(data_);
+        }
+        const_iterator begin() const noexcept {
+            return std::cbegin(data_);
+        }
+        iterator end() noexcept {
+            return std::end(data_);
+        }
+        const_iterator end() const noexcept {
+            return std::cend(data_);
+        }
+
+        std::size_t size() const noexcept {
+            return data_.size();
+        }
+        bool empty() const noexcept {
+            return data_.empty();
+        }
+
+        iterator lower_bound(const Key &k) {
+            return std::lower_bound(begin(), end(), k, less_key);
+        }
+        const_iterator lower_bound(const Key &k) const {
+            return std::lower_bound(begin(), end(), k, less_key);
+        }
+        iterator upper_bound(const Key &k) {
+            return std::upper_bound(begin(), end(), k, key_less);
+        }
+        const_iterator upper_bound(const Key &k) const {
+            return std::upper_bound(begin(), end(), k, key_less);
+        }
+
+        // hint は k の挿入位置でなければならない
+        iterator emplace_hint(const_iterator hint, const Key &k, const T &x) {
+            assert(hint == end() || k < hint->first);
+            assert(hint == begin() || std::prev(hint)->first < k);
+
+            return data_.emplace(hint, k, x);
+        }
+
+        T &operator [](const Key &k) {
+            auto iter = lower_bound(k);
+
+            if (iter == end() || k < iter->first) {
+                iter = data_.emplace(iter, k, T());
+            }
+
+            return iter->second;
+        }
+
+        iterator erase(const_iterator iter) {
+            return data_.erase(iter);
+        }
+        iterator erase(const_iterator first, const_iterator last) {
+            return data_.erase(first, last);
+        }
+        std::size_t erase(const Key &k) {
+            auto iter = lower_bound(k);
+
+            if (iter == end() || k < iter->first) {
+                return 0;
+            }
+            data_.erase(iter);
+
+            return 1;
+        }
+
+        void clear() noexcept {
+            data_.clear();
+        }
+
+        void reserve(std::size_t n) {
+            data_.reserve(n);
+        }
+
+    private:
+        static bool less_key(const value_type &x, const Key &k) {
+            return x.first < k;
+        }
+        static bool key_less(const Key &k, const value_type &x) {
+            return k < x.first;
+        }
+
+        std::vector<value_type, Allocator> data_;
+    };
+
     // 互いに重ならない区間の集合 { [l1, r1), [l2, r2), ... } を管理する (li < ri)
-    template <typename Int>
+    // Map は区間の左端から右端への連想配列 (std::map または flat_map)
+    // Map のアロケータは索引の木の節点にも使う (arena_segment_set を参照)
+    template <typename Int, typename Map = std::map<Int, Int>>
     struct segment_set {
         using int_type = Int;
+        using map_type = Map;
+        using allocator_type = typename Map::allocator_type;
+
+        segment_set(): segment_set(allocator_type()) {
+        }
+
+        explicit segment_set(const allocator_type &alloc):
+            seg_(alloc), count_(0), length_(0), lo_(0), index_(0, alloc) {
+        }
 
-        segment_set(): seg_() {
+        // 全ての区間が [lo, hi) に収まる場合
+        // covered_length, next_gap が O(log (hi - lo)) になる
+        // (他の構築子では索引を持たず, これらは O(区間の個数) かかる)
+        segment_set(int_type lo, int_type hi, const allocator_type &alloc = allocator_type()):
+            seg_(alloc), count_(0), length_(0), lo_(lo), index_(hi - lo, alloc) {
+            assert(lo <= hi);
         }
 
     public:
@@ -32,7 +159,9 @@ namespace stcp {
             if (iter1 != std::begin(seg_)) {
                 std::advance(iter1, -1);
                 if (l < iter1->second) {
+                    // 左の区間は put_ が同じ左端で上書きするので, 個数と長さからだけ除く (索引も put_ が上書きする)
                     l = iter1->first;
+                    --count_; length_ -= iter1->second - iter1->first;
                 }
                 std::advance(iter1, +1);
             }
@@ -45,9 +174,9 @@ namespace stcp {
                 std::advance(iter2, +1);
             }
 
-            seg_.erase(iter1, iter2);
+            erase_(iter1, iter2);
 
-            seg_[l] = r;
+            put_(l, r);
         }
 
         // 区間 [l, r) を追加する
@@ -61,7 +190,7 @@ namespace stcp {
 
             clear(l, r);
 
-            seg_[l] = r;
+            put_(l, r);
         }
 
         // 要素 [x, k), [k, y) を [x, y) へマージする
@@ -78,9 +207,8 @@ namespace stcp {
             auto [l2, r2] = *iter1;
 
             if (r1 == k && l2 == k) {
-                seg_.erase(iter1);
-                seg_.erase(iter2);
-                seg_[l1] = r2;
+                erase_(iter2, std::next(iter1));
+                put_(l1, r2);
             }
         }
 
@@ -94,9 +222,14 @@ namespace stcp {
 
             auto [l, r] = *_;
 
-            seg_.erase(l);
-            seg_[l] = k;
-            seg_[k] = r;
+            if (l == k) {
+                return;
+            }
+
+            auto iter = seg_.lower_bound(l);
+            erase_(iter, std::next(iter));
+            put_(l, k);
+            put_(k, r);
         }
 
         // 集合から [l, r) に重なる部分を *切り取り* 削除する
@@ -110,24 +243,122 @@ namespace stcp {
             remove_covered(l, r);
         }
 
-        // [l, r) に重なる区間を集合からすべて取り除く
-        void remove_covered(int_type l, int_type r) {
-            assert(l <= r);
+        // O(size(segment_set) + (last - first))
+        // 左端の昇順に並んだ区間列 [first, last) をまとめて insert する
+        template <typename Iter>
+        void insert_sorted(Iter first, Iter last) {
+            std::vector<std::pair<int_type, int_type>> res;
+            res.reserve(count_ + std::distance(first, last));
 
-            auto iter = seg_.upper_bound(l);
+            auto push = [&](int_type l, int_type r) {
+                if (l == r) {
+                    return;
+                }
+                if (!res.empty() && l < res.back().second) {
+                    res.back().second = std::max(res.back().second, r);
+                    return;
+                }
+                res.emplace_back(l, r);
+            };
 
-            if (iter != std::begin(seg_)) {
-                std::advance(iter, -1);
+            auto iter = std::begin(seg_);
+            while (iter != std::end(seg_) || first != last) {
+                if (first == last || (iter != std::end(seg_) && iter->first <= std::get<0>(*first))) {
+                    push(iter->first, iter->second); ++iter;
+                }
+                else {
+                    auto [l, r] = *first;
+                    assert(l <= r);
+                    push(l, r); ++first;
+                }
             }
 
-            while (iter != std::end(seg_) && iter->first < r) {
-                if (l < iter->second) {
-                    iter = seg_.erase(iter);
+            assign_(res);
+        }
+
+        template <typename Range>
+        void insert_sorted(const Range &range) {
+            insert_sorted(std::begin(range), std::end(range));
+        }
+
+        // O(size(segment_set) + size(other))
+        // other の各区間を insert する
+        void unite(const segment_set &other) {
+            insert_sorted(std::begin(other.seg_), std::end(other.seg_));
+        }
+
+        // O(size(segment_set) + size(other))
+        // 各区間を other に覆われている部分に切り詰める
+        void intersect(const segment_set &other) {
+            std::vector<std::pair<int_type, int_type>> res;
+            res.reserve(count_ + other.count_);
+
+            auto iter1 = std::begin(seg_);
+            auto iter2 = std::begin(other.seg_);
+            while (iter1 != std::end(seg_) && iter2 != std::end(other.seg_)) {
+                auto l = std::max(iter1->first, iter2->first);
+                auto r = std::min(iter1->second, iter2->second);
+
+                if (l < r) {
+                    res.emplace_back(l, r);
+                }
+
+                if (iter1->second < iter2->second) {
+                    ++iter1;
                 }
                 else {
-                    std::advance(iter, +1);
+                    ++iter2;
+                }
+            }
+
+            assign_(res);
+        }
+
+        // O(size(segment_set) + size(other))
+        // other の各区間 [l, r) について clear(l, r) する
+        void subtract(const segment_set &other) {
+            std::vector<std::pair<int_type, int_type>> res;
+            res.reserve(count_ + other.count_);
+
+            auto iter2 = std::begin(other.seg_);
+            for (auto [l, r] : seg_) {
+                while (iter2 != std::end(other.seg_) && iter2->second <= l) {
+                    ++iter2;
+                }
+
+                auto k = l;
+                for (auto iter = iter2; iter != std::end(other.seg_) && iter->first < r; ++iter) {
+                    if (k < iter->first) {
+                        res.emplace_back(k, iter->first);
+                    }
+                    k = std::max(k, iter->second);
+                }
+
+                if (k < r) {
+                    res.emplace_back(k, r);
+                }
+            }
+
+            assign_(res);
+        }
+
+        // [l, r) に重なる区間を集合からすべて取り除く
+        void remove_covered(int_type l, int_type r) {
+            assert(l <= r);
+
+            auto iter1 = seg_.upper_bound(l);
+            auto iter2 = seg_.lower_bound(r);
+
+            if (iter1 != std::begin(seg_)) {
+                std::advance(iter1, -1);
+                if (iter1->second <= l) {
+                    std::advance(iter1, +1);
                 }
             }
+
+            if (iter1 != std::end(seg_) && iter1->first < r) {
+                erase_(iter1, iter2);
+            }
         }
 
         // 存在するのなら l <= k < r な区間 [l, r) を返す
@@ -177,9 +408,238 @@ namespace stcp {
             return l <= y && y < r;
         }
 
+        // [l, r) に重なる区間を [l, r) に切り詰めて左から列挙する範囲
+        // 集合を変更すると無効になる
+        struct interval_range {
+            using base_iterator = typename map_type::const_iterator;
+
+            struct iterator {
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = std::pair<int_type, int_type>;
+                using difference_type = std::ptrdiff_t;
+                using pointer = void;
+                using reference = value_type;
+
+                value_type operator *() const {
+                    return value_type(std::max(l_, iter_->first), std::min(r_, iter_->second));
+                }
+
+                iterator &operator ++() {
+                    ++iter_;
+                    return *this;
+                }
+                iterator operator ++(int) {
+                    auto copy = *this;
+                    ++iter_;
+                    return copy;
+                }
+
+                bool operator ==(const iterator &other) const {
+                    return iter_ == other.iter_;
+                }
+                bool operator !=(const iterator &other) const {
+                    return iter_ != other.iter_;
+                }
+
+                base_iterator iter_;
+                int_type l_, r_;
+            };
+
+            iterator begin() const {
+                return iterator{ first_, l_, r_ };
+            }
+            iterator end() const {
+                return iterator{ last_, l_, r_ };
+            }
+
+            bool empty() const {
+                return first_ == last_;
+            }
+
+            base_iterator first_, last_;
+            int_type l_, r_;
+        };
+
+        // O(log n)
+        interval_range intervals(int_type l, int_type r) const {
+            assert(l <= r);
+
+            auto last = seg_.lower_bound(r);
+
+            if (l == r) {
+                return interval_range{ last, last, l, r };
+            }
+
+            auto first = seg_.upper_bound(l);
+
+            if (first != std::begin(seg_) && l < std::prev(first)->second) {
+                std::advance(first, -1);
+            }
+
+            return interval_range{ first, last, l, r };
+        }
+
+        // O(1)
+        interval_range intervals() const {
+            return interval_range{
+                std::begin(seg_), std::end(seg_),
+                std::numeric_limits<int_type>::lowest(), std::numeric_limits<int_type>::max()
+            };
+        }
+
+        // O(1)
+        // 区間の個数
+        std::size_t size() const noexcept {
+            return count_;
+        }
+
+        // O(1)
+        // 区間の長さの総和
+        int_type length() const noexcept {
+            return length_;
+        }
+
+        // (lo, hi) で構築した場合 O(log (hi - lo)), そうでなければ O(log n + [l, r) と交わる区間の個数)
+        // [l, r) のうち区間に覆われている長さ
+        int_type covered_length(int_type l, int_type r) const {
+            assert(l <= r);
+
+            int_type sum = 0;
+
+            if (auto _ = wrapped(l); _.has_value() && _->first < l) {
+                sum += std::min(r, _->second) - l;
+            }
+
+            if (indexed()) {
+                auto hi = lo_ + int_type(index_.size());
+                auto a = std::clamp(l, lo_, hi), b = std::clamp(r, lo_, hi);
+                sum += index_.prod(a - lo_, b - lo_).length;
+            }
+            else {
+                for (auto iter = seg_.lower_bound(l); iter != std::end(seg_) && iter->first < r; ++iter) {
+                    sum += iter->second - iter->first;
+                }
+            }
+
+            if (auto _ = wrapped(r); _.has_value() && l <= _->first && _->first < r) {
+                sum -= _->second - r;
+            }
+
+            return sum;
+        }
+
+        // (lo, hi) で構築した場合 O(log (hi - lo)), そうでなければ O(log n + 飛ばす区間の個数)
+        // x 以上で区間に覆われていない最小の点
+        // 接している区間はまとめて飛ばす
+        int_type next_gap(int_type x) const {
+            auto _ = wrapped(x);
+
+            if (!_.has_value()) {
+                return x;
+            }
+
+            auto [l, r] = *_;
+
+            if (indexed()) {
+                auto p = index_.max_right(l - lo_, [](const summary &s) {
+                    return s.chain;
+                });
+                return index_.prod(l - lo_, p).r;
+            }
+
+            for (auto iter = seg_.lower_bound(r); iter != std::end(seg_) && iter->first == r; ++iter) {
+                r = iter->second;
+            }
+
+            return r;
+        }
+
+    private:
+        // 左端の位置に置く区間の情報
+        // chain: 含まれる区間が隙間なく接しているか
+        struct summary {
+            bool empty, chain;
+            int_type l, r, length;
+        };
+
+        static summary summary_op(summary x, summary y) {
+            if (x.empty) {
+                return y;
+            }
+            if (y.empty) {
+                return x;
+            }
+            return summary{ false, x.chain && y.chain && x.r == y.l, x.l, y.r, x.length + y.length };
+        }
+        static summary summary_e() {
+            return summary{ true, true, 0, 0, 0 };
+        }
+
+        bool indexed() const noexcept {
+            return 0 < index_.size();
+        }
+
+        void put_(int_type l, int_type r) {
+            seg_[l] = r;
+
+            added_(l, r);
+        }
+
+        // 左端の昇順に並んだ互いに重ならない区間列で集合を置き換える
+        void assign_(const std::vector<std::pair<int_type, int_type>> &v) {
+            seg_.clear();
+
+            count_ = 0; length_ = 0;
+            if (indexed()) {
+                index_.clear();
+            }
+
+            for (auto [l, r] : v) {
+                seg_.emplace_hint(std::end(seg_), l, r);
+                added_(l, r);
+            }
+        }
+
+        void added_(int_type l, int_type r) {
+            ++count_; length_ += r - l;
+
+            if (indexed()) {
+                assert(lo_ <= l && l - lo_ < int_type(index_.size()));
+                index_.set(l - lo_, summary{ false, true, l, r, r - l });
+            }
+        }
+
+        template <typename Iter>
+        void erase_(Iter first, Iter last) {
+            for (auto iter = first; iter != last; ++iter) {
+                --count_; length_ -= iter->second - iter->first;
+
+                if (indexed()) {
+                    index_.set(iter->first - lo_, summary_e());
+                }
+            }
+
+            seg_.erase(first, last);
+        }
+
     private:
-        std::map<int_type, int_type> seg_;
+        map_type seg_;
+
+        std::size_t count_;
+        int_type length_;
+
+        int_type lo_;
+        dynamic_segment_tree<summary, summary_op, summary_e,
+            typename std::allocator_traits<allocator_type>::template rebind_alloc<summary>> index_;
     };
+
+    template <typename Int>
+    using flat_segment_set = segment_set<Int, flat_map<Int, Int>>;
+
+    // 区間と索引の節点を monotonic_arena から確保する segment_set
+    // segment_set(arena) のように作り, 破棄した後に arena.reset() で全て使い直せる
+    template <typename Int>
+    using arena_segment_set = segment_set<Int, std::map<Int, Int, std::less<Int>, arena_allocator<std::pair<const Int, Int>>>>;
 }
 
 #endif // STCP_SEGMENT_SET_HPP
@@ -4,13 +4,21 @@
 #include <type_traits>
 #include <utility>
 #include <vector>
+#include <memory>
 #include <cassert>
 #include <cstddef>
+#include "stcp/monoid.hpp"
+#include "stcp/stats.hpp"
 
 namespace stcp {
-    template <typename S, S (*Op)(S, S), S (*E)()>
-    struct segment_tree {
+    // 節点の列は Allocator で確保する (huge_page_allocator など)
+    // STCP_ENABLE_STATS のとき stats() で Op の呼び出し・節点の訪問・確保の回数を返す
+    // Idempotent (Op(x, x) = x, min, max, gcd など) ならば set は値の変わらなかった節点で止まる (S の == で比べる)
+    // monoid.hpp のモノイドからは segment_tree_of で作ると, モノイドの idempotent から決まる
+    template <typename S, S (*Op)(S, S), S (*E)(), bool Idempotent = false, typename Allocator = std::allocator<S>>
+    struct segment_tree: stats_recorder<segment_tree<S, Op, E, Idempotent, Allocator>> {
         using value_type = S;
+        using allocator_type = Allocator;
 
         // O(1)
         segment_tree():
@@ -18,33 +26,33 @@ namespace stcp {
         }
 
         // O(n)
-        explicit segment_tree(std::size_t n):
-            n_(n) {
+        explicit segment_tree(std::size_t n, const Allocator &alloc = Allocator()):
+            data_(alloc), n_(n) {
             log_ = 0;
             while ((std::size_t(1) << log_) < n_) {
                 ++log_;
             }
             size_ = (1 << log_);
 
-            data_ = std::vector<S>(size_ + size_, E());
+            data_.assign(size_ + size_, E());
         }
 
         // O(size(v))
-        explicit segment_tree(const std::vector<S> &v):
-            n_(v.size()) {
+        explicit segment_tree(const std::vector<S> &v, const Allocator &alloc = Allocator()):
+            data_(alloc), n_(v.size()) {
             log_ = 0;
             while ((std::size_t(1) << log_) < n_) {
                 ++log_;
             }
             size_ = (1 << log_);
 
-            data_ = std::vector<S>(size_ + size_, E());
+            data_.assign(size_ + size_, E());
             for (std::size_t i = 0; i < n_; ++i) {
                 data_[i + size_] = v[i];
             }
 
             for (std::size_t i = size_ - 1; 1 <= i; --i) {
-                data_[i] = Op(data_[i + i], data_[i + i + 1]);
+                data_[i] = op(data_[i + i], data_[i + i + 1]);
             }
         }
 
@@ -52,20 +60,30 @@ namespace stcp {
         // O(log size(segment_tree))
         // 0 <= i < size(segment_tree)
         void set(std::size_t i, S x) {
-            assert(0 <= i && i < n_);
+            assert(i < n_);
 
             i += size_;
 
             data_[i] = x; i >>= 1;
             while (1 <= i) {
-                data_[i] = Op(data_[i + i], data_[i + i + 1]);
+                recorder::count_visit();
+                S y = op(data_[i + i], data_[i + i + 1]);
+
+                // 冪等なら値の変わらないことが多く, そのとき祖先も変わらない
+                if constexpr (Idempotent) {
+                    if (y == data_[i]) {
+                        break;
+                    }
+                }
+
+                data_[i] = y;
                 i >>= 1;
             }
         }
         // O(1)
         // 0 <= i < size(segment_tree)
         S get(std::size_t i) const {
-            assert(0 <= i && i < n_);
+            assert(i < n_);
 
             return data_[i + size_];
         }
@@ -73,22 +91,23 @@ namespace stcp {
         // O(log size(segment_tree))
         // 0 <= l <= r <= size(segment_tree)
         S prod(std::size_t l, std::size_t r) const {
-            assert(0 <= l && l <= r && r <= n_);
+            assert(l <= r && r <= n_);
 
             l += size_; r += size_;
 
             S accl = E(), accr = E();
             while (l < r) {
+                recorder::count_visit();
                 if (l & 1) {
-                    accl = Op(accl, data_[l++]);
+                    accl = op(accl, data_[l++]);
                 }
                 if (r & 1) {
-                    accr = Op(data_[--r], accr);
+                    accr = op(data_[--r], accr);
                 }
                 l >>= 1; r >>= 1;
             }
 
-            return Op(accl, accr);
+            return op(accl, accr);
         }
 
         // O(1)
@@ -102,12 +121,13 @@ namespace stcp {
         void acc(std::size_t l, std::size_t r, F &&f) const {
             static_assert(std::is_invocable_v<F, S>);
 
-            assert(0 <= l && l <= r && r <= n_);
+            assert(l <= r && r <= n_);
 
             l += size_; r += size_;
 
             std::size_t log_ = 0, pr = r;
             while (l < pr) {
+                recorder::count_visit();
                 if (l & 1) {
                     std::forward<F>(f)(data_[l++]);
                 }
@@ -115,6 +135,7 @@ namespace stcp {
             }
 
             while (pr < size_) {
+                recorder::count_visit();
                 pr <<= 1;
                 if (pr != (r >> (log_ - 1))) {
                     std::forward<F>(f)(data_[pr]);
@@ -130,7 +151,7 @@ namespace stcp {
         std::size_t max_right(std::size_t l, F &&f) const {
             static_assert(std::is_invocable_r_v<bool, F, S>);
 
-            assert(0 <= l && l <= n_);
+            assert(l <= n_);
             assert(std::forward<F>(f)(E()));
 
             if (l == n_) {
@@ -140,7 +161,8 @@ namespace stcp {
 
             S acc = E();
             while (((l & (l << 1)) | 1) != l) {
-                if (S con = Op(acc, data_[l]); std::forward<F>(f)(con)) {
+                recorder::count_visit();
+                if (S con = op(acc, data_[l]); std::forward<F>(f)(con)) {
                     if (l & 1) {
                         acc = con; ++l;
                     }
@@ -150,13 +172,14 @@ namespace stcp {
                 break;
             }
 
-            if (std::forward<F>(f)(Op(acc, data_[l]))) {
+            if (std::forward<F>(f)(op(acc, data_[l]))) {
                 return n_;
             }
 
             while (l < size_) {
+                recorder::count_visit();
                 l <<= 1;
-                if (S con = Op(acc, data_[l]); std::forward<F>(f)(con)) {
+                if (S con = op(acc, data_[l]); std::forward<F>(f)(con)) {
                     acc = con; ++l;
                 }
             }
@@ -170,7 +193,7 @@ namespace stcp {
         std::size_t min_left(std::size_t r, F &&f) const {
             static_assert(std::is_invocable_r_v<bool, F, S>);
 
-            assert(0 <= r && r <= n_);
+            assert(r <= n_);
             assert(std::forward<F>(f)(E()));
 
             if (r == 0) {
@@ -180,7 +203,8 @@ namespace stcp {
 
             S acc = E();
             while ((r & -r) != r) {
-                if (S con = Op(data_[r], acc); std::forward<F>(f)(con)) {
+                recorder::count_visit();
+                if (S con = op(data_[r], acc); std::forward<F>(f)(con)) {
                     if ((r & 1) == 0) {
                         acc = con; --r;
                     }
@@ -190,13 +214,14 @@ namespace stcp {
                 break;
             }
 
-            if (std::forward<F>(f)(Op(data_[r], acc))) {
+            if (std::forward<F>(f)(op(data_[r], acc))) {
                 return 0;
             }
 
             while (r < size_) {
+                recorder::count_visit();
                 r <<= 1; ++r;
-                if (S con = Op(data_[r], acc); std::forward<F>(f)(con)) {
+                if (S con = op(data_[r], acc); std::forward<F>(f)(con)) {
                     acc = con; --r;
                 }
             }
@@ -205,9 +230,21 @@ namespace stcp {
         }
 
     private:
-        std::vector<S> data_;
+        using recorder = stats_recorder<segment_tree>;
+
+        static S op(S x, S y) {
+            recorder::count_op();
+            return Op(x, y);
+        }
+
+    private:
+        std::vector<S, Allocator> data_;
         std::size_t n_, size_, log_;
     };
+
+    // モノイド M (min_monoid など) の op, e を使う segment_tree
+    template <typename M, typename Allocator = std::allocator<typename M::value_type>>
+    using segment_tree_of = segment_tree<typename M::value_type, M::op, M::e, is_idempotent_v<M>, Allocator>;
 }
 
 #endif // STCP_SEGMENT_TREE_HPP
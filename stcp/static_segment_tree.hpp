@@ -0,0 +1,199 @@
+#ifndef STCP_STATIC_SEGMENT_TREE_HPP
+#define STCP_STATIC_SEGMENT_TREE_HPP
+
+#include <type_traits>
+#include <utility>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include "stcp/monoid.hpp"
+
+namespace stcp {
+    // 要素数 N を型で決めた segment_tree
+    // 節点は std::array に持って動的確保をせず, 全ての操作が constexpr (S がリテラル型なら定数式で構築・質問できる)
+    // Idempotent は segment_tree と同じ
+    template <typename S, S (*Op)(S, S), S (*E)(), std::size_t N, bool Idempotent = false>
+    struct static_segment_tree {
+        using value_type = S;
+
+        // O(N)
+        constexpr static_segment_tree():
+            data_() {
+            for (std::size_t i = 0; i < size_ + size_; ++i) {
+                data_[i] = E();
+            }
+        }
+
+        // O(N)
+        explicit constexpr static_segment_tree(const std::array<S, N> &v):
+            data_() {
+            for (std::size_t i = 0; i < size_; ++i) {
+                data_[i + size_] = i < N ? v[i] : E();
+            }
+
+            for (std::size_t i = size_ - 1; 1 <= i; --i) {
+                data_[i] = Op(data_[i + i], data_[i + i + 1]);
+            }
+        }
+
+    public:
+        // O(1)
+        static constexpr std::size_t size() noexcept {
+            return N;
+        }
+
+        // O(log N)
+        // 0 <= i < N
+        constexpr void set(std::size_t i, S x) {
+            assert(i < N);
+
+            i += size_;
+
+            data_[i] = x; i >>= 1;
+            while (1 <= i) {
+                S y = Op(data_[i + i], data_[i + i + 1]);
+
+                // 冪等なら値の変わらないことが多く, そのとき祖先も変わらない
+                if constexpr (Idempotent) {
+                    if (y == data_[i]) {
+                        break;
+                    }
+                }
+
+                data_[i] = y;
+                i >>= 1;
+            }
+        }
+        // O(1)
+        // 0 <= i < N
+        constexpr S get(std::size_t i) const {
+            assert(i < N);
+
+            return data_[i + size_];
+        }
+
+        // O(log N)
+        // 0 <= l <= r <= N
+        constexpr S prod(std::size_t l, std::size_t r) const {
+            assert(l <= r && r <= N);
+
+            l += size_; r += size_;
+
+            S accl = E(), accr = E();
+            while (l < r) {
+                if (l & 1) {
+                    accl = Op(accl, data_[l++]);
+                }
+                if (r & 1) {
+                    accr = Op(data_[--r], accr);
+                }
+                l >>= 1; r >>= 1;
+            }
+
+            return Op(accl, accr);
+        }
+
+        // O(1)
+        constexpr S all_prod() const {
+            return data_[1];
+        }
+
+        // O(log N)
+        // 0 <= l <= N
+        template <typename F>
+        constexpr std::size_t max_right(std::size_t l, F &&f) const {
+            static_assert(std::is_invocable_r_v<bool, F, S>);
+
+            assert(l <= N);
+            assert(std::forward<F>(f)(E()));
+
+            if (l == N) {
+                return N;
+            }
+            l += size_;
+
+            S acc = E();
+            while (((l & (l << 1)) | 1) != l) {
+                if (S con = Op(acc, data_[l]); std::forward<F>(f)(con)) {
+                    if (l & 1) {
+                        acc = con; ++l;
+                    }
+                    l >>= 1;
+                    continue;
+                }
+                break;
+            }
+
+            if (std::forward<F>(f)(Op(acc, data_[l]))) {
+                return N;
+            }
+
+            while (l < size_) {
+                l <<= 1;
+                if (S con = Op(acc, data_[l]); std::forward<F>(f)(con)) {
+                    acc = con; ++l;
+                }
+            }
+
+            return l - size_;
+        }
+
+        // O(log N)
+        // 0 <= r <= N
+        template <typename F>
+        constexpr std::size_t min_left(std::size_t r, F &&f) const {
+            static_assert(std::is_invocable_r_v<bool, F, S>);
+
+            assert(r <= N);
+            assert(std::forward<F>(f)(E()));
+
+            if (r == 0) {
+                return 0;
+            }
+            r += size_; --r;
+
+            S acc = E();
+            while ((r & -r) != r) {
+                if (S con = Op(data_[r], acc); std::forward<F>(f)(con)) {
+                    if ((r & 1) == 0) {
+                        acc = con; --r;
+                    }
+                    r >>= 1;
+                    continue;
+                }
+                break;
+            }
+
+            if (std::forward<F>(f)(Op(data_[r], acc))) {
+                return 0;
+            }
+
+            while (r < size_) {
+                r <<= 1; ++r;
+                if (S con = Op(data_[r], acc); std::forward<F>(f)(con)) {
+                    acc = con; --r;
+                }
+            }
+
+            return r + 1 - size_;
+        }
+
+    private:
+        static constexpr std::size_t log_ = [] {
+            std::size_t log = 0;
+            while ((std::size_t(1) << log) < N) {
+                ++log;
+            }
+            return log;
+        }();
+        static constexpr std::size_t size_ = std::size_t(1) << log_;
+
+        std::array<S, size_ + size_> data_;
+    };
+
+    // モノイド M の op, e を使う static_segment_tree
+    template <typename M, std::size_t N>
+    using static_segment_tree_of = static_segment_tree<typename M::value_type, M::op, M::e, N, is_idempotent_v<M>>;
+}
+
+#endif // STCP_STATIC_SEGMENT_TREE_HPP
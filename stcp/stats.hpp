@@ -0,0 +1,79 @@
+#ifndef STCP_STATS_HPP
+#define STCP_STATS_HPP
+
+#include <cstdint>
+
+namespace stcp {
+    // 木の操作が行った仕事の回数
+    //   op_calls: Op の呼び出し, node_visits: 辿った節点, lazy_pushes: 遅延作用を子へ下ろした回数, allocations: 節点の確保
+    //   (allocations は節点を 1 つずつ確保する木だけが数える. 配列で持つ木は構築時にまとめて確保するので数えない)
+    struct tree_stats {
+        std::uint64_t op_calls = 0, node_visits = 0, lazy_pushes = 0, allocations = 0;
+    };
+
+    // STCP_ENABLE_STATS を定義すると, これを継承した木は型ごと・スレッドごとに回数を数える
+    // (同じ型の木はスレッド内で 1 つのカウンタを共有する. 操作の前後で stats() の差をとって使う)
+    // 定義しなければ空の基底になり, 数える呼び出しは最適化で消える
+    // Tag は数える先を決める型 (通常は継承する木自身)
+#ifdef STCP_ENABLE_STATS
+    template <typename Tag>
+    struct stats_recorder {
+        static constexpr bool stats_enabled = true;
+
+        // O(1)
+        static const tree_stats &stats() noexcept {
+            return stats_;
+        }
+
+        // O(1)
+        static void reset_stats() noexcept {
+            stats_ = tree_stats();
+        }
+
+    protected:
+        static void count_op() noexcept {
+            ++stats_.op_calls;
+        }
+        static void count_visit() noexcept {
+            ++stats_.node_visits;
+        }
+        static void count_push() noexcept {
+            ++stats_.lazy_pushes;
+        }
+        static void count_allocation() noexcept {
+            ++stats_.allocations;
+        }
+
+    private:
+        inline static thread_local tree_stats stats_;
+    };
+#else
+    template <typename Tag>
+    struct stats_recorder {
+        static constexpr bool stats_enabled = false;
+
+        // O(1)
+        // 常に 0
+        static const tree_stats &stats() noexcept {
+            static constexpr tree_stats zero;
+            return zero;
+        }
+
+        // O(1)
+        static void reset_stats() noexcept {
+        }
+
+    protected:
+        static constexpr void count_op() noexcept {
+        }
+        static constexpr void count_visit() noexcept {
+        }
+        static constexpr void count_push() noexcept {
+        }
+        static constexpr void count_allocation() noexcept {
+        }
+    };
+#endif // STCP_ENABLE_STATS
+}
+
+#endif // STCP_STATS_HPP
@@ -0,0 +1,427 @@
+#ifndef STCP_TREE_LIFTING_HPP
+#define STCP_TREE_LIFTING_HPP
+
+#include <utility>
+#include <algorithm>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include "stcp/functional_graph_doubling.hpp"
+
+namespace stcp {
+    // 根付き森 (根 r は parent[r] = r) の頂点を, 親が子より先に来る順に並べる
+    // O(n)
+    template <typename Index>
+    std::vector<Index> tree_order(const std::vector<Index> &parent) {
+        auto n = parent.size();
+
+        std::vector<std::size_t> offset(n + 1, 0);
+        for (std::size_t v = 0; v < n; ++v) {
+            assert(std::size_t(parent[v]) < n);
+
+            if (std::size_t(parent[v]) != v) {
+                ++offset[parent[v] + 1];
+            }
+        }
+        for (std::size_t v = 0; v < n; ++v) {
+            offset[v + 1] += offset[v];
+        }
+
+        std::vector<Index> child(n);
+        {
+            auto pos = offset;
+            for (std::size_t v = 0; v < n; ++v) {
+                if (std::size_t(parent[v]) != v) {
+                    child[pos[parent[v]]++] = Index(v);
+                }
+            }
+        }
+
+        std::vector<Index> order;
+        order.reserve(n);
+        for (std::size_t v = 0; v < n; ++v) {
+            if (std::size_t(parent[v]) == v) {
+                order.push_back(Index(v));
+            }
+        }
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            auto v = order[i];
+            for (auto j = offset[v]; j < offset[v + 1]; ++j) {
+                order.push_back(child[j]);
+            }
+        }
+
+        assert(order.size() == n);
+
+        return order;
+    }
+
+    // Euler tour と sparse table による LCA
+    // 構築 O(n log n), クエリ O(1)
+    template <typename Index>
+    struct euler_tour_lca {
+        // O(1)
+        euler_tour_lca():
+            first_(), depth_(), table_() {
+        }
+
+        // O(n log n)
+        // 根 r は parent[r] = r
+        explicit euler_tour_lca(const std::vector<Index> &parent):
+            first_(parent.size()), depth_(parent.size(), 0), table_() {
+
+            auto n = parent.size();
+
+            std::vector<std::size_t> offset(n + 1, 0);
+            for (std::size_t v = 0; v < n; ++v) {
+                if (std::size_t(parent[v]) != v) {
+                    ++offset[parent[v] + 1];
+                }
+            }
+            for (std::size_t v = 0; v < n; ++v) {
+                offset[v + 1] += offset[v];
+            }
+
+            std::vector<Index> child(n);
+            {
+                auto pos = offset;
+                for (std::size_t v = 0; v < n; ++v) {
+                    if (std::size_t(parent[v]) != v) {
+                        child[pos[parent[v]]++] = Index(v);
+                    }
+                }
+            }
+
+            std::vector<Index> tour;
+            tour.reserve(2 * n);
+
+            // (頂点, 次に見る子の位置)
+            std::vector<std::pair<Index, std::size_t>> stack;
+            for (std::size_t r = 0; r < n; ++r) {
+                if (std::size_t(parent[r]) != r) {
+                    continue;
+                }
+
+                stack.emplace_back(Index(r), offset[r]);
+                first_[r] = Index(tour.size());
+                tour.push_back(Index(r));
+
+                while (!stack.empty()) {
+                    auto &[v, j] = stack.back();
+
+                    if (j == offset[v + 1]) {
+                        stack.pop_back();
+                        if (!stack.empty()) {
+                            tour.push_back(stack.back().first);
+                        }
+                        continue;
+                    }
+
+                    auto u = child[j++];
+                    depth_[u] = depth_[v] + 1;
+                    first_[u] = Index(tour.size());
+                    tour.push_back(u);
+                    stack.emplace_back(u, offset[u]);
+                }
+            }
+
+            table_.push_back(std::move(tour));
+            for (std::size_t i = 1; (std::size_t(1) << i) <= table_[0].size(); ++i) {
+                auto &prev = table_[i - 1];
+                auto w = std::size_t(1) << (i - 1);
+
+                std::vector<Index> cur(prev.size() - w);
+                for (std::size_t j = 0; j < cur.size(); ++j) {
+                    cur[j] = shallower(prev[j], prev[j + w]);
+                }
+                table_.push_back(std::move(cur));
+            }
+        }
+
+    public:
+        // O(1)
+        std::size_t depth(Index v) const {
+            return depth_[v];
+        }
+
+        // O(1)
+        // u, v は同じ木に属する
+        Index lca(Index u, Index v) const {
+            auto l = std::size_t(first_[u]), r = std::size_t(first_[v]);
+            if (r < l) {
+                std::swap(l, r);
+            }
+
+            auto i = 63 - __builtin_clzll(r - l + 1);
+            return shallower(table_[i][l], table_[i][r + 1 - (std::size_t(1) << i)]);
+        }
+
+    private:
+        Index shallower(Index u, Index v) const {
+            return depth_[u] <= depth_[v] ? u : v;
+        }
+
+    private:
+        std::vector<Index> first_, depth_;
+        std::vector<std::vector<Index>> table_;
+    };
+
+    // 根付き森上の k 個上の祖先, LCA, パス上の辺の集約
+    // 辺 v -> parent[v] の重みを weight[v] とし, (S, Op, E) はモノイド
+    // functional_graph_doubling の段を親の表として使う (メモリ O(n log n))
+    template <typename Index, typename S, S (*Op)(S, S), S (*E)()>
+    struct tree_lifting {
+        using index_type = Index;
+        using value_type = S;
+
+        // O(n log n)
+        // 根 r は parent[r] = r
+        // euler_lca ならば lca を Euler tour と sparse table で O(1) にする
+        tree_lifting(const std::vector<Index> &parent, const std::vector<S> &weight, bool euler_lca = false):
+            depth_(parent.size(), 0),
+            dub_(build(parent, weight, depth_)),
+            euler_(euler_lca ? euler_tour_lca<Index>(parent) : euler_tour_lca<Index>()),
+            euler_lca_(euler_lca) {
+        }
+
+    public:
+        // O(1)
+        std::size_t size() const noexcept {
+            return depth_.size();
+        }
+
+        // O(1)
+        std::size_t depth(Index v) const {
+            return depth_[v];
+        }
+
+        // O(log k)
+        // 0 <= k <= depth(v)
+        Index ancestor(Index v, std::size_t k) const {
+            assert(k <= std::size_t(depth_[v]));
+
+            for (std::size_t i = 0; 0 < k; ++i, k >>= 1) {
+                if (k & 1) {
+                    v = dub_.next(i, v);
+                }
+            }
+
+            return v;
+        }
+
+        // O(1) (euler_lca) / O(log n)
+        // u, v は同じ木に属する
+        Index lca(Index u, Index v) const {
+            if (euler_lca_) {
+                return euler_.lca(u, v);
+            }
+
+            if (depth_[u] < depth_[v]) {
+                std::swap(u, v);
+            }
+            u = ancestor(u, depth_[u] - depth_[v]);
+
+            if (u == v) {
+                return u;
+            }
+
+            for (auto i = dub_.log2() + 1; 0 < i--; ) {
+                if (dub_.next(i, u) != dub_.next(i, v)) {
+                    u = dub_.next(i, u);
+                    v = dub_.next(i, v);
+                }
+            }
+
+            return dub_.next(0, u);
+        }
+
+        // O(1) (euler_lca) / O(log n)
+        std::size_t distance(Index u, Index v) const {
+            return depth_[u] + depth_[v] - 2 * depth_[lca(u, v)];
+        }
+
+        // O(log n)
+        // u から v へのパス上の辺の重みを通る順に畳み込む
+        S prod(Index u, Index v) const {
+            auto w = lca(u, v);
+
+            auto up = dub_.jump(u, depth_[u] - depth_[w]).second.up;
+            auto down = dub_.jump(v, depth_[v] - depth_[w]).second.down;
+
+            return Op(up, down);
+        }
+
+    private:
+        // 根へ向かう向きと, その逆向きの畳み込み
+        struct path_value {
+            S up, down;
+        };
+
+        static path_value path_op(path_value x, path_value y) {
+            return { Op(x.up, y.up), Op(y.down, x.down) };
+        }
+        static path_value path_e() {
+            return { E(), E() };
+        }
+
+        using table_type = functional_graph_doubling<Index, path_value, path_op, path_e>;
+
+        static table_type build(const std::vector<Index> &parent, const std::vector<S> &weight, std::vector<Index> &depth) {
+            assert(parent.size() == weight.size());
+
+            std::size_t max_depth = 0;
+            for (auto v : tree_order(parent)) {
+                if (parent[v] != v) {
+                    depth[v] = depth[parent[v]] + 1;
+                    max_depth = std::max<std::size_t>(max_depth, depth[v]);
+                }
+            }
+
+            std::size_t log2 = 0;
+            while ((std::size_t(1) << (log2 + 1)) <= max_depth) {
+                ++log2;
+            }
+
+            std::vector<path_value> agg(parent.size());
+            for (std::size_t v = 0; v < parent.size(); ++v) {
+                agg[v] = std::size_t(parent[v]) != v ? path_value{ weight[v], weight[v] } : path_e();
+            }
+
+            return table_type(log2, parent, agg);
+        }
+
+    private:
+        std::vector<Index> depth_;
+        table_type dub_;
+        euler_tour_lca<Index> euler_;
+        bool euler_lca_;
+    };
+
+    // tree_lifting と同じ操作を jump pointer で行う (メモリ O(n), 各クエリ O(log n))
+    // jump[v] は親の jump の並びから決まり, 深さだけに依存する歩幅を持つ
+    template <typename Index, typename S, S (*Op)(S, S), S (*E)()>
+    struct compact_tree_lifting {
+        using index_type = Index;
+        using value_type = S;
+
+        // O(n)
+        // 根 r は parent[r] = r
+        compact_tree_lifting(const std::vector<Index> &parent, const std::vector<S> &weight):
+            parent_(parent), jump_(parent.size()), depth_(parent.size(), 0),
+            up_(parent.size(), E()), down_(parent.size(), E()),
+            jump_up_(parent.size(), E()), jump_down_(parent.size(), E()) {
+
+            assert(parent.size() == weight.size());
+
+            for (auto v : tree_order(parent)) {
+                auto p = parent[v];
+
+                if (p == v) {
+                    jump_[v] = v;
+                    continue;
+                }
+
+                depth_[v] = depth_[p] + 1;
+                up_[v] = down_[v] = weight[v];
+
+                auto j = jump_[p];
+                if (depth_[p] - depth_[j] == depth_[j] - depth_[jump_[j]] && j != p) {
+                    jump_[v] = jump_[j];
+                    jump_up_[v] = Op(Op(weight[v], jump_up_[p]), jump_up_[j]);
+                    jump_down_[v] = Op(Op(jump_down_[j], jump_down_[p]), weight[v]);
+                }
+                else {
+                    jump_[v] = p;
+                    jump_up_[v] = jump_down_[v] = weight[v];
+                }
+            }
+        }
+
+    public:
+        // O(1)
+        std::size_t size() const noexcept {
+            return parent_.size();
+        }
+
+        // O(1)
+        std::size_t depth(Index v) const {
+            return depth_[v];
+        }
+
+        // O(log n)
+        // 0 <= k <= depth(v)
+        Index ancestor(Index v, std::size_t k) const {
+            assert(k <= std::size_t(depth_[v]));
+
+            auto d = depth_[v] - k;
+            while (d < std::size_t(depth_[v])) {
+                v = d <= std::size_t(depth_[jump_[v]]) ? jump_[v] : parent_[v];
+            }
+
+            return v;
+        }
+
+        // O(log n)
+        // u, v は同じ木に属する
+        Index lca(Index u, Index v) const {
+            if (depth_[u] < depth_[v]) {
+                std::swap(u, v);
+            }
+            u = ancestor(u, depth_[u] - depth_[v]);
+
+            while (u != v) {
+                if (jump_[u] != jump_[v]) {
+                    u = jump_[u]; v = jump_[v];
+                }
+                else {
+                    u = parent_[u]; v = parent_[v];
+                }
+            }
+
+            return u;
+        }
+
+        // O(log n)
+        std::size_t distance(Index u, Index v) const {
+            return depth_[u] + depth_[v] - 2 * depth_[lca(u, v)];
+        }
+
+        // O(log n)
+        // u から v へのパス上の辺の重みを通る順に畳み込む
+        S prod(Index u, Index v) const {
+            auto w = lca(u, v);
+            auto d = std::size_t(depth_[w]);
+
+            S up = E();
+            while (d < std::size_t(depth_[u])) {
+                if (d <= std::size_t(depth_[jump_[u]])) {
+                    up = Op(up, jump_up_[u]); u = jump_[u];
+                }
+                else {
+                    up = Op(up, up_[u]); u = parent_[u];
+                }
+            }
+
+            S down = E();
+            while (d < std::size_t(depth_[v])) {
+                if (d <= std::size_t(depth_[jump_[v]])) {
+                    down = Op(jump_down_[v], down); v = jump_[v];
+                }
+                else {
+                    down = Op(down_[v], down); v = parent_[v];
+                }
+            }
+
+            return Op(up, down);
+        }
+
+    private:
+        std::vector<Index> parent_, jump_, depth_;
+
+        // 親への辺, jump への辺の列の, 根へ向かう向きとその逆向きの畳み込み
+        std::vector<S> up_, down_, jump_up_, jump_down_;
+    };
+}
+
+#endif // STCP_TREE_LIFTING_HPP